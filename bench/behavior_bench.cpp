@@ -0,0 +1,108 @@
+/*
+ * Enemy behavior benchmark
+ *
+ * Runs one behavior across growing batches of ships and reports, as JSON,
+ * how much of the 120 Hz simulation tick each batch size uses.
+ *
+ * usage: jage_bench_behavior [behaviors.yaml] [behavior name] [ticks]
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <string>
+
+#include <easylogging++.h>
+
+#include <Behavior.hpp>
+#include <memory.hpp>
+
+INITIALIZE_EASYLOGGINGPP
+
+using namespace std::chrono_literals;
+
+int main(const int argc, const char** argv) {
+	const std::string fileName = argc > 1 ? argv[1] : "game/behaviors.yaml";
+	const std::string behaviorName = argc > 2 ? argv[2] : "hunter";
+	const uint32_t ticks = std::max(2u, argc > 3 ? static_cast<uint32_t>(std::stoul(argv[3])) : 1200u);
+
+	// same world size and tick rate as the Engine
+	const float worldWidth = 1280.0f;
+	const float worldHeight = 720.0f;
+	const float tickSeconds = 1.0f / 120.0f;
+	const double tickBudgetMs = 1000.0 / 120.0;
+	// Sprite's default speed
+	const float speed = 10.0f;
+
+	BehaviorLibrary behaviors;
+	if (!behaviors.loadFromYAML(fileName)) {
+		std::cerr << "Can't load behaviors from '" << fileName << "'" << std::endl;
+		return EXIT_FAILURE;
+	}
+	const BehaviorProgram* program = behaviors.find(behaviorName);
+	if (program == nullptr) {
+		std::cerr << "No behavior named '" << behaviorName << "'" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	std::cout << "{\"benchmark\": \"behavior\", \"behavior\": \"" << behaviorName << "\", "
+		<< "\"ticks\": " << ticks << ", \"tickBudgetMs\": " << tickBudgetMs << ", \"results\": [";
+
+	const uint32_t shipCounts[] = {1000, 2000, 4000, 8000, 16000, 32000};
+	bool first = true;
+	for (const auto& shipCount : shipCounts) {
+		BehaviorBatch batch(*program);
+		// spread the ships over the top half of the screen
+		const auto columns = static_cast<uint32_t>(std::sqrt(static_cast<float>(shipCount) * 2.0f));
+		for (uint32_t i = 0; i < shipCount; i++) {
+			batch.add(
+				static_cast<float>(i % columns) * worldWidth / static_cast<float>(columns),
+				static_cast<float>(i / columns) * worldHeight / 2.0f / static_cast<float>(shipCount / columns + 1)
+			);
+		}
+
+		float targetX = worldWidth / 2.0f;
+		const float targetY = worldHeight * 3.0f / 4.0f;
+		std::chrono::nanoseconds totalTime = 0ns;
+		std::chrono::nanoseconds maxTime = 0ns;
+		uint64_t shots = 0;
+		uint64_t allocations = 0;
+
+		for (uint32_t tick = 0; tick < ticks; tick++) {
+			// keep the target moving so formations never settle completely
+			targetX = worldWidth / 2.0f + std::sin(static_cast<float>(tick) * tickSeconds) * worldWidth / 4.0f;
+
+			const uint64_t allocationStart = threadAllocationCount();
+			const auto start = std::chrono::steady_clock::now();
+			batch.evaluate(tickSeconds, targetX, targetY);
+			for (size_t i = 0; i < batch.size(); i++) {
+				batch.x[i] += batch.dirX[i] * speed * tickSeconds;
+				batch.y[i] += batch.dirY[i] * speed * tickSeconds;
+			}
+			const std::chrono::nanoseconds elapsed = std::chrono::steady_clock::now() - start;
+			// the first tick sizes the output buffers, don't count it
+			if (tick > 0) {
+				allocations += threadAllocationCount() - allocationStart;
+			}
+
+			totalTime += elapsed;
+			maxTime = std::max(maxTime, elapsed);
+			shots += batch.fired.size();
+		}
+
+		const double averageMs = static_cast<double>(totalTime.count()) / ticks / 1e6;
+		std::cout << (first ? "" : ",") << "\n\t{"
+			<< "\"ships\": " << shipCount << ", "
+			<< "\"averageTickMs\": " << averageMs << ", "
+			<< "\"maxTickMs\": " << static_cast<double>(maxTime.count()) / 1e6 << ", "
+			<< "\"budgetUsedPercent\": " << averageMs / tickBudgetMs * 100.0 << ", "
+			<< "\"shipsPerMs\": " << shipCount / averageMs << ", "
+			<< "\"shotsPerSecond\": " << static_cast<double>(shots) / (static_cast<double>(ticks) * tickSeconds) << ", "
+			<< "\"allocationsPerTick\": " << static_cast<double>(allocations) / (ticks - 1)
+			<< "}";
+		first = false;
+	}
+	std::cout << "\n]}" << std::endl;
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,540 @@
+/*
+ * Stress scene benchmark suite
+ *
+ * Builds scenes of ships, projectiles and particles from the presets in
+ * bench/scenes, runs the update, collision, draw list and offscreen render
+ * phases of each frame, and reports per-phase timings as JSON. Compares
+ * the results against a saved baseline and exits non-zero on a regression.
+ *
+ * usage: jage_bench [options] [scene.yaml...]
+ *   --frames <n>            override every scene's frame count
+ *   --baseline <file>       compare against this baseline (bench/baseline.json)
+ *   --threshold <percent>   how much slower a phase may get before it fails (10)
+ *   --save-baseline <file>  write the results as a new baseline
+ *   --no-render             skip the offscreen render phase
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <easylogging++.h>
+
+#include <SFML/Graphics/RenderTexture.hpp>
+
+#include <Arena.hpp>
+#include <Sprite.hpp>
+#include <memory.hpp>
+
+INITIALIZE_EASYLOGGINGPP
+
+using namespace std::chrono_literals;
+
+namespace {
+
+// same world size and tick rate as the Engine
+const float WORLD_WIDTH = 1280.0f;
+const float WORLD_HEIGHT = 720.0f;
+const std::chrono::nanoseconds TICK_TIME = std::chrono::nanoseconds(1s) / 120;
+const float PI = 3.14159265f;
+
+const char* const PHASES[] = {"update", "collision", "drawList", "render"};
+const size_t PHASE_COUNT = 4;
+enum Phase {
+	UPDATE,
+	COLLISION,
+	DRAW_LIST,
+	RENDER
+};
+
+struct EntityPreset {
+	uint32_t count = 0;
+	uint32_t vertices = 4;
+	float size = 10.0f;
+	float speed = 50.0f;
+};
+
+struct ScenePreset {
+	std::string name;
+	uint32_t seed = 1;
+	uint32_t frames = 600;
+	EntityPreset ships;
+	EntityPreset projectiles;
+	EntityPreset particles;
+	float collisionCellSize = 64.0f;
+};
+
+struct PhaseResult {
+	bool ran = false;
+	double averageMs = 0.0;
+	double p50Ms = 0.0;
+	double p99Ms = 0.0;
+	double maxMs = 0.0;
+	double allocationsPerFrame = 0.0;
+};
+
+struct SceneResult {
+	std::string name;
+	uint32_t frames = 0;
+	size_t entities = 0;
+	size_t vertices = 0;
+	uint64_t collisions = 0;
+	PhaseResult phases[PHASE_COUNT];
+};
+
+// the same as the Engine's render thread builds
+struct DrawCommand {
+	const Sprite* sprite;
+	sf::Transform transform;
+};
+
+EntityPreset nodeToEntityPreset(const YAML::Node& node) {
+	EntityPreset preset;
+	if (node) {
+		preset.count = node["count"].as<uint32_t>(preset.count);
+		preset.vertices = std::max(3u, node["vertices"].as<uint32_t>(preset.vertices));
+		preset.size = node["size"].as<float>(preset.size);
+		preset.speed = node["speed"].as<float>(preset.speed);
+	}
+	return preset;
+}
+
+ScenePreset loadScenePreset(const std::string& fileName) {
+	const YAML::Node node = YAML::LoadFile(fileName);
+	ScenePreset preset;
+	preset.name = node["name"].as<std::string>(fileName);
+	preset.seed = node["seed"].as<uint32_t>(preset.seed);
+	preset.frames = node["frames"].as<uint32_t>(preset.frames);
+	preset.ships = nodeToEntityPreset(node["ships"]);
+	preset.projectiles = nodeToEntityPreset(node["projectiles"]);
+	preset.particles = nodeToEntityPreset(node["particles"]);
+	preset.collisionCellSize = std::max(1.0f, node["collisionCellSize"].as<float>(preset.collisionCellSize));
+	return preset;
+}
+
+// a regular polygon in the sprite definition format, so it goes through the real loader
+YAML::Node makeMeshDefinition(const EntityPreset& preset, const sf::Color& color) {
+	YAML::Node definition;
+	definition["type"] = "sprite";
+	definition["size"] = preset.size;
+	for (uint32_t i = 0; i < preset.vertices; i++) {
+		const float angle = 2.0f * PI * static_cast<float>(i) / static_cast<float>(preset.vertices);
+		definition["vertices"].push_back(std::vector<float>{std::cos(angle), std::sin(angle)});
+	}
+	definition["colors"].push_back(std::vector<int>{color.r, color.g, color.b});
+	YAML::Node colorIndex;
+	colorIndex["color"] = 1;
+	definition["indexes"].push_back(colorIndex);
+	// zig-zag across the polygon as one triangle strip: 1, 2, n, 3, n-1...
+	std::vector<uint32_t> strip;
+	uint32_t low = 1;
+	uint32_t high = preset.vertices;
+	strip.push_back(low++);
+	while (low <= high) {
+		strip.push_back(low++);
+		if (low <= high) {
+			strip.push_back(high--);
+		}
+	}
+	definition["indexes"].push_back(strip);
+	return definition;
+}
+
+void addEntities(
+	const std::string& name,
+	const EntityPreset& preset,
+	const sf::Color& color,
+	std::mt19937& random,
+	std::vector<std::shared_ptr<Sprite>>& sprites
+) {
+	if (preset.count == 0) {
+		return;
+	}
+	// load once, then copy, like the waves do
+	const Sprite prototype(name, makeMeshDefinition(preset, color));
+	std::uniform_real_distribution<float> x(0.0f, WORLD_WIDTH);
+	std::uniform_real_distribution<float> y(0.0f, WORLD_HEIGHT);
+	std::uniform_real_distribution<float> angle(0.0f, 2.0f * PI);
+	for (uint32_t i = 0; i < preset.count; i++) {
+		auto sprite = std::make_shared<Sprite>(prototype);
+		sprite->setPosition(x(random), y(random));
+		const float heading = angle(random);
+		sprite->setRotation(heading * 180.0f / PI);
+		sprite->setVelocityDir(std::cos(heading), std::sin(heading));
+		sprite->setSpeed(preset.speed);
+		sprites.push_back(sprite);
+	}
+}
+
+// bounce off the edges, so the scene keeps its density
+void keepInWorld(Sprite& sprite) {
+	const sf::Vector2f& position = sprite.getPosition();
+	sf::Vector2f direction = sprite.getVelocityDir();
+	if ((position.x < 0.0f && direction.x < 0.0f) || (position.x > WORLD_WIDTH && direction.x > 0.0f)) {
+		direction.x = -direction.x;
+	}
+	if ((position.y < 0.0f && direction.y < 0.0f) || (position.y > WORLD_HEIGHT && direction.y > 0.0f)) {
+		direction.y = -direction.y;
+	}
+	sprite.setVelocityDir(direction.x, direction.y);
+}
+
+// uniform grid broadphase: bucket the ships by cell, then test each projectile
+// against the ships in its own and the neighbouring cells
+class CollisionGrid {
+public:
+	CollisionGrid(const float _cellSize, const float maxRadius) :
+		cellSize(_cellSize),
+		columns(static_cast<size_t>(std::ceil(WORLD_WIDTH / _cellSize))),
+		rows(static_cast<size_t>(std::ceil(WORLD_HEIGHT / _cellSize))),
+		reach(static_cast<int>(std::ceil(maxRadius * 2.0f / _cellSize))),
+		cellStart(columns * rows + 1) {
+	}
+
+	uint64_t countHits(
+		const std::vector<std::shared_ptr<Sprite>>& sprites,
+		const size_t shipsBegin,
+		const size_t shipsEnd,
+		const float shipRadius,
+		const size_t projectilesBegin,
+		const size_t projectilesEnd,
+		const float projectileRadius
+	) {
+		// counting sort of the ships into cells, the vectors only grow on the first frame
+		std::fill(cellStart.begin(), cellStart.end(), 0);
+		shipCells.resize(shipsEnd - shipsBegin);
+		for (size_t ship = shipsBegin; ship < shipsEnd; ship++) {
+			const size_t cell = cellOf(sprites[ship]->getPosition());
+			shipCells[ship - shipsBegin] = cell;
+			cellStart[cell + 1]++;
+		}
+		for (size_t cell = 1; cell < cellStart.size(); cell++) {
+			cellStart[cell] += cellStart[cell - 1];
+		}
+		cellShips.resize(shipCells.size());
+		cellFill.assign(cellStart.begin(), cellStart.end() - 1);
+		for (size_t ship = 0; ship < shipCells.size(); ship++) {
+			cellShips[cellFill[shipCells[ship]]++] = ship + shipsBegin;
+		}
+
+		const float hitDistance = shipRadius + projectileRadius;
+		uint64_t hits = 0;
+		for (size_t projectile = projectilesBegin; projectile < projectilesEnd; projectile++) {
+			const sf::Vector2f& position = sprites[projectile]->getPosition();
+			const int column = clampColumn(position.x);
+			const int row = clampRow(position.y);
+			for (int y = std::max(0, row - reach); y <= std::min(static_cast<int>(rows) - 1, row + reach); y++) {
+				for (int x = std::max(0, column - reach); x <= std::min(static_cast<int>(columns) - 1, column + reach); x++) {
+					const auto cell = static_cast<size_t>(y) * columns + static_cast<size_t>(x);
+					for (size_t i = cellStart[cell]; i < cellStart[cell + 1]; i++) {
+						const sf::Vector2f offset = sprites[cellShips[i]]->getPosition() - position;
+						if (offset.x * offset.x + offset.y * offset.y < hitDistance * hitDistance) {
+							hits++;
+						}
+					}
+				}
+			}
+		}
+		return hits;
+	}
+
+private:
+	int clampColumn(const float x) const {
+		return std::min(static_cast<int>(columns) - 1, std::max(0, static_cast<int>(x / cellSize)));
+	}
+
+	int clampRow(const float y) const {
+		return std::min(static_cast<int>(rows) - 1, std::max(0, static_cast<int>(y / cellSize)));
+	}
+
+	size_t cellOf(const sf::Vector2f& position) const {
+		return static_cast<size_t>(clampRow(position.y)) * columns + static_cast<size_t>(clampColumn(position.x));
+	}
+
+	const float cellSize;
+	const size_t columns;
+	const size_t rows;
+	// how many cells out a hit can be, for ships bigger than a cell
+	const int reach;
+	std::vector<size_t> cellStart;
+	std::vector<size_t> cellFill;
+	std::vector<size_t> shipCells;
+	std::vector<size_t> cellShips;
+};
+
+class PhaseTimer {
+public:
+	explicit PhaseTimer(const uint32_t frames) {
+		samples.reserve(frames);
+	}
+
+	void start() {
+		allocationStart = threadAllocationCount();
+		startTime = std::chrono::steady_clock::now();
+	}
+
+	void stop() {
+		const std::chrono::nanoseconds elapsed = std::chrono::steady_clock::now() - startTime;
+		samples.push_back(static_cast<double>(elapsed.count()) / 1e6);
+		allocations += threadAllocationCount() - allocationStart;
+	}
+
+	PhaseResult result() {
+		PhaseResult phase;
+		if (samples.empty()) {
+			return phase;
+		}
+		phase.ran = true;
+		double total = 0.0;
+		for (const double sample : samples) {
+			total += sample;
+		}
+		phase.averageMs = total / static_cast<double>(samples.size());
+		std::sort(samples.begin(), samples.end());
+		phase.p50Ms = samples[samples.size() / 2];
+		phase.p99Ms = samples[std::min(samples.size() - 1, samples.size() * 99 / 100)];
+		phase.maxMs = samples.back();
+		phase.allocationsPerFrame = static_cast<double>(allocations) / static_cast<double>(samples.size());
+		return phase;
+	}
+
+private:
+	std::vector<double> samples;
+	std::chrono::steady_clock::time_point startTime;
+	uint64_t allocationStart = 0;
+	uint64_t allocations = 0;
+};
+
+SceneResult runScene(const ScenePreset& preset, const bool render) {
+	SceneResult result;
+	result.name = preset.name;
+	result.frames = preset.frames;
+
+	std::mt19937 random(preset.seed);
+	std::vector<std::shared_ptr<Sprite>> sprites;
+	addEntities("ship", preset.ships, sf::Color(0, 128, 255), random, sprites);
+	const size_t projectilesBegin = sprites.size();
+	addEntities("projectile", preset.projectiles, sf::Color(255, 255, 0), random, sprites);
+	const size_t projectilesEnd = sprites.size();
+	addEntities("particle", preset.particles, sf::Color(255, 128, 0), random, sprites);
+	result.entities = sprites.size();
+	result.vertices = preset.ships.count * preset.ships.vertices
+		+ preset.projectiles.count * preset.projectiles.vertices
+		+ preset.particles.count * preset.particles.vertices;
+
+	CollisionGrid grid(preset.collisionCellSize, std::max(preset.ships.size, preset.projectiles.size) / 2.0f);
+
+	sf::RenderTexture target;
+	const bool canRender = render
+		&& target.create(static_cast<unsigned int>(WORLD_WIDTH), static_cast<unsigned int>(WORLD_HEIGHT));
+	if (render && !canRender) {
+		std::cerr << "No offscreen render target available, skipping the render phase" << std::endl;
+	}
+
+	PhaseTimer timers[PHASE_COUNT] = {
+		PhaseTimer(preset.frames), PhaseTimer(preset.frames), PhaseTimer(preset.frames), PhaseTimer(preset.frames)
+	};
+	for (uint32_t frame = 0; frame < preset.frames; frame++) {
+		frameArena().reset();
+
+		timers[UPDATE].start();
+		for (const auto& sprite : sprites) {
+			keepInWorld(*sprite);
+			sprite->update(TICK_TIME);
+		}
+		timers[UPDATE].stop();
+
+		timers[COLLISION].start();
+		result.collisions += grid.countHits(
+			sprites, 0, projectilesBegin, preset.ships.size / 2.0f,
+			projectilesBegin, projectilesEnd, preset.projectiles.size / 2.0f
+		);
+		timers[COLLISION].stop();
+
+		timers[DRAW_LIST].start();
+		ArenaVector<DrawCommand> drawList{ArenaAllocator<DrawCommand>(frameArena())};
+		drawList.reserve(sprites.size());
+		for (const auto& sprite : sprites) {
+			drawList.push_back({sprite.get(), sprite->getTransform()});
+		}
+		timers[DRAW_LIST].stop();
+
+		if (canRender) {
+			timers[RENDER].start();
+			target.clear(sf::Color::Black);
+			for (const auto& command : drawList) {
+				command.sprite->drawWithTransform(target, command.transform);
+			}
+			target.display();
+			timers[RENDER].stop();
+		}
+	}
+
+	for (size_t phase = 0; phase < PHASE_COUNT; phase++) {
+		result.phases[phase] = timers[phase].result();
+	}
+	return result;
+}
+
+std::string resultsToJson(const std::vector<SceneResult>& results) {
+	std::ostringstream json;
+	json << "{\"benchmark\": \"suite\", \"results\": [";
+	for (size_t scene = 0; scene < results.size(); scene++) {
+		const SceneResult& result = results[scene];
+		json << (scene == 0 ? "" : ",") << "\n\t{"
+			<< "\"scene\": \"" << result.name << "\", "
+			<< "\"frames\": " << result.frames << ", "
+			<< "\"entities\": " << result.entities << ", "
+			<< "\"vertices\": " << result.vertices << ", "
+			<< "\"collisionsPerFrame\": " << static_cast<double>(result.collisions) / result.frames << ", "
+			<< "\"phases\": {";
+		bool first = true;
+		for (size_t phase = 0; phase < PHASE_COUNT; phase++) {
+			const PhaseResult& timing = result.phases[phase];
+			if (!timing.ran) {
+				continue;
+			}
+			json << (first ? "" : ",") << "\n\t\t\"" << PHASES[phase] << "\": {"
+				<< "\"averageMs\": " << timing.averageMs << ", "
+				<< "\"p50Ms\": " << timing.p50Ms << ", "
+				<< "\"p99Ms\": " << timing.p99Ms << ", "
+				<< "\"maxMs\": " << timing.maxMs << ", "
+				<< "\"entitiesPerMs\": " << (timing.averageMs > 0.0 ? static_cast<double>(result.entities) / timing.averageMs : 0.0) << ", "
+				<< "\"allocationsPerFrame\": " << timing.allocationsPerFrame
+				<< "}";
+			first = false;
+		}
+		json << "\n\t}}";
+	}
+	json << "\n]}";
+	return json.str();
+}
+
+// JSON is close enough to YAML for yaml-cpp to read the baseline back
+// returns how many phases got slower than the threshold allows
+uint32_t compareWithBaseline(const std::vector<SceneResult>& results, const std::string& fileName, const double threshold) {
+	YAML::Node baseline;
+	try {
+		baseline = YAML::LoadFile(fileName);
+	} catch (YAML::Exception& e) {
+		std::cerr << "No baseline at '" << fileName << "', nothing to compare against" << std::endl;
+		return 0;
+	}
+
+	uint32_t regressions = 0;
+	std::cerr << "Compared with '" << fileName << "', allowing " << threshold << "% slower:" << std::endl;
+	for (const auto& result : results) {
+		const YAML::Node scenes = baseline["results"];
+		YAML::Node baselineScene;
+		for (auto&& sceneIter = scenes.begin(); sceneIter != scenes.end(); sceneIter++) {
+			if (sceneIter->operator[]("scene").as<std::string>("") == result.name) {
+				baselineScene.reset(*sceneIter);
+			}
+		}
+		if (!baselineScene) {
+			std::cerr << "\t" << result.name << ": not in the baseline" << std::endl;
+			continue;
+		}
+		for (size_t phase = 0; phase < PHASE_COUNT; phase++) {
+			const YAML::Node baselinePhase = baselineScene["phases"][PHASES[phase]];
+			if (!result.phases[phase].ran || !baselinePhase) {
+				continue;
+			}
+			const double before = baselinePhase["averageMs"].as<double>(0.0);
+			const double after = result.phases[phase].averageMs;
+			const double change = before > 0.0 ? (after - before) / before * 100.0 : 0.0;
+			const bool regressed = change > threshold;
+			std::cerr << "\t" << result.name << "." << PHASES[phase] << ": "
+				<< before << "ms -> " << after << "ms (" << (change >= 0.0 ? "+" : "") << change << "%)"
+				<< (regressed ? " REGRESSION" : "") << std::endl;
+			if (regressed) {
+				regressions++;
+			}
+		}
+	}
+	return regressions;
+}
+
+}
+
+int main(const int argc, const char** argv) {
+	// Sprite logs every vertex it loads, and the JSON has stdout to itself
+	el::Configurations logging;
+	logging.setGlobally(el::ConfigurationType::Enabled, "false");
+	el::Loggers::reconfigureLogger("default", logging);
+
+	std::vector<std::string> sceneFiles;
+	uint32_t frames = 0;
+	std::string baselineFile = "bench/baseline.json";
+	std::string saveBaselineFile;
+	double threshold = 10.0;
+	bool render = true;
+	for (int arg = 1; arg < argc; arg++) {
+		const std::string option = argv[arg];
+		const bool hasValue = arg + 1 < argc;
+		if (option == "--frames" && hasValue) {
+			frames = static_cast<uint32_t>(std::stoul(argv[++arg]));
+		} else if (option == "--baseline" && hasValue) {
+			baselineFile = argv[++arg];
+		} else if (option == "--threshold" && hasValue) {
+			threshold = std::stod(argv[++arg]);
+		} else if (option == "--save-baseline" && hasValue) {
+			saveBaselineFile = argv[++arg];
+		} else if (option == "--no-render") {
+			render = false;
+		} else if (option.compare(0, 2, "--") == 0) {
+			std::cerr << "Unknown option '" << option << "'" << std::endl;
+			return EXIT_FAILURE;
+		} else {
+			sceneFiles.push_back(option);
+		}
+	}
+	if (sceneFiles.empty()) {
+		sceneFiles = {"bench/scenes/small.yaml", "bench/scenes/medium.yaml", "bench/scenes/stress.yaml", "bench/scenes/meshes.yaml"};
+	}
+
+	std::vector<SceneResult> results;
+	for (const auto& sceneFile : sceneFiles) {
+		ScenePreset preset;
+		try {
+			preset = loadScenePreset(sceneFile);
+		} catch (YAML::Exception& e) {
+			std::cerr << "Can't load scene '" << sceneFile << "': " << e.what() << std::endl;
+			return EXIT_FAILURE;
+		}
+		if (frames > 0) {
+			preset.frames = frames;
+		}
+		preset.frames = std::max(1u, preset.frames);
+		std::cerr << "Running '" << preset.name << "' for " << preset.frames << " frames" << std::endl;
+		results.push_back(runScene(preset, render));
+	}
+
+	const std::string json = resultsToJson(results);
+	std::cout << json << std::endl;
+
+	if (!saveBaselineFile.empty()) {
+		std::ofstream baseline(saveBaselineFile, std::ios::trunc);
+		baseline << json << std::endl;
+		if (!baseline) {
+			std::cerr << "Can't write baseline '" << saveBaselineFile << "'" << std::endl;
+			return EXIT_FAILURE;
+		}
+		std::cerr << "Saved baseline to '" << saveBaselineFile << "'" << std::endl;
+		return EXIT_SUCCESS;
+	}
+
+	const uint32_t regressions = compareWithBaseline(results, baselineFile, threshold);
+	if (regressions > 0) {
+		std::cerr << regressions << " phases regressed" << std::endl;
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,336 @@
+/*
+ * Asset & config parsing benchmark
+ *
+ * Generates a large sprite definition, then reports, as JSON, how long turning the
+ * loaded YAML into geometry takes and how many heap allocations it makes, both the
+ * old way (looking keys up by name and converting with as<T>()) and through the
+ * schemas and fixed-size vertex & color readers. The config gets the same treatment.
+ *
+ * usage: jage_bench_parse [vertices] [iterations]
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <easylogging++.h>
+
+#include <yaml-cpp/yaml.h>
+
+#include <Config.hpp>
+#include <Schema.hpp>
+#include <Sprite.hpp>
+#include <memory.hpp>
+#include <utilities.hpp>
+
+INITIALIZE_EASYLOGGINGPP
+
+using namespace std::chrono_literals;
+
+namespace {
+
+struct Result {
+	std::chrono::nanoseconds time = 0ns;
+	uint64_t allocations = 0;
+	uint64_t bytes = 0;
+};
+
+struct Geometry {
+	float size = 0.0f;
+	float rotation = 0.0f;
+	std::string behavior;
+	std::vector<sf::Vertex> vertices;
+};
+
+// a strip of quads, every fourth vertex changes color
+std::string makeSpriteDefinition(const uint32_t vertexCount) {
+	std::stringstream yaml;
+	yaml << "type: sprite\nsize: 40\nrotation: 90\nbehavior: swarm\nvertices:\n";
+	for (uint32_t i = 0; i < vertexCount; i++) {
+		yaml << "  - [" << static_cast<float>(i % 200) / 100.0f - 1.0f << ", " << (i % 2 == 0 ? -0.5f : 0.5f) << "]\n";
+	}
+	const uint32_t colorCount = std::max(1u, vertexCount / 4);
+	yaml << "colors:\n";
+	for (uint32_t i = 0; i < colorCount; i++) {
+		yaml << "  - [" << i % 256 << ", " << (i * 7) % 256 << ", " << (i * 13) % 256 << (i % 3 == 0 ? "" : ", 200") << "]\n";
+	}
+	yaml << "indexes:\n";
+	for (uint32_t i = 0; i < vertexCount; i += 4) {
+		yaml << "  - color: " << i / 4 % colorCount + 1 << "\n  - [";
+		for (uint32_t j = i; j < std::min(vertexCount, i + 4); j++) {
+			yaml << (j == i ? "" : ", ") << j + 1;
+		}
+		yaml << "]\n";
+	}
+	return yaml.str();
+}
+
+// how Sprite read its definition before it had a schema
+bool legacyParseSprite(const YAML::Node& dataFile, Geometry& geometry) {
+	if (dataFile["type"].as<std::string>("") != "sprite") {
+		return false;
+	}
+	geometry.size = dataFile["size"].as<float>(50.0f);
+	geometry.rotation = dataFile["rotation"].as<float>(0.0f);
+	geometry.behavior = dataFile["behavior"].as<std::string>("");
+
+	std::vector<sf::Vertex> vertexList;
+	YAML::Node vertexListNode = dataFile["vertices"];
+	vertexList.reserve(vertexListNode.size());
+	for (auto&& vertexIter = vertexListNode.begin(); vertexIter != vertexListNode.end(); vertexIter++) {
+		const YAML::Node& node = *vertexIter;
+		vertexList.push_back(sf::Vertex(sf::Vector2f(node[0].as<float>(), node[1].as<float>()) * (geometry.size / 2.0f)));
+	}
+
+	std::vector<sf::Color> colorList;
+	YAML::Node colorListNode = dataFile["colors"];
+	colorList.reserve(colorListNode.size());
+	for (auto&& colorIter = colorListNode.begin(); colorIter != colorListNode.end(); colorIter++) {
+		const YAML::Node& node = *colorIter;
+		std::vector<uint8_t> color = {255, 255, 255, 255};
+		uint8_t i = 0;
+		for (auto&& primary : color) {
+			primary = static_cast<uint8_t>(std::min(node[i++].as<uint32_t>(255), 255u));
+		}
+		colorList.push_back(sf::Color(color[0], color[1], color[2], color[3]));
+	}
+
+	YAML::Node indexList = dataFile["indexes"];
+	sf::Color color;
+	for (auto&& indexIter = indexList.begin(); indexIter != indexList.end(); indexIter++) {
+		if (indexIter->Type() == YAML::NodeType::Map) {
+			color = colorList[indexIter->operator[]("color").as<uint32_t>(0) - 1];
+			continue;
+		}
+		for (auto indexIter2 = indexIter->begin(); indexIter2 != indexIter->end(); indexIter2++) {
+			sf::Vertex vertex = vertexList[indexIter2->as<uint32_t>(0) - 1];
+			vertex.color = color;
+			geometry.vertices.push_back(vertex);
+		}
+	}
+	return true;
+}
+
+// the same steps Sprite::loadFromNode takes now, without the logging
+bool schemaParseSprite(const YAML::Node& dataFile, Geometry& geometry) {
+	SpriteDefinition definition;
+	definition.size = 50.0f;
+	SchemaErrors errors;
+	if (!parseSpriteDefinition(dataFile, definition, SchemaPath{nullptr, "bench"}, errors) || definition.type != "sprite") {
+		return false;
+	}
+	geometry.size = definition.size;
+	geometry.rotation = definition.rotation;
+	geometry.behavior.swap(definition.behavior);
+
+	std::vector<sf::Vertex> vertexList;
+	vertexList.reserve(definition.vertices.size());
+	for (const auto& node : definition.vertices) {
+		sf::Vertex vertex;
+		if (!nodeToVertex(node, geometry.size, vertex)) {
+			return false;
+		}
+		vertexList.push_back(vertex);
+	}
+
+	std::vector<sf::Color> colorList;
+	colorList.reserve(definition.colors.size());
+	for (const auto& node : definition.colors) {
+		sf::Color color;
+		if (!nodeToColor(node, color)) {
+			return false;
+		}
+		colorList.push_back(color);
+	}
+
+	sf::Color color;
+	for (const auto& indexNode : definition.indexes) {
+		unsigned long index = 0;
+		if (indexNode.IsMap()) {
+			if (!scalarToUnsigned(indexNode["color"], colorList.size(), index) || index == 0) {
+				return false;
+			}
+			color = colorList[index - 1];
+			continue;
+		}
+		for (const auto& vertexIndex : indexNode) {
+			if (!scalarToUnsigned(vertexIndex, vertexList.size(), index) || index == 0) {
+				return false;
+			}
+			sf::Vertex vertex = vertexList[index - 1];
+			vertex.color = color;
+			geometry.vertices.push_back(vertex);
+		}
+	}
+	return true;
+}
+
+ThreadSettings legacyThreadSettings(const YAML::Node& node, const ThreadSettings& defaults) {
+	ThreadSettings settings = defaults;
+	if (!node || node.Type() != YAML::NodeType::Map) {
+		return settings;
+	}
+	settings.name = node["name"].as<std::string>(settings.name);
+	YAML::Node coresNode = node["cores"];
+	if (coresNode && coresNode.Type() == YAML::NodeType::Sequence) {
+		settings.cores.clear();
+		for (auto&& coreIter = coresNode.begin(); coreIter != coresNode.end(); coreIter++) {
+			settings.cores.push_back(coreIter->as<unsigned int>());
+		}
+	}
+	const std::string& policy = node["policy"].as<std::string>("default");
+	if (policy == "fifo") {
+		settings.policy = ThreadSettings::Policy::Fifo;
+	} else if (policy == "nice") {
+		settings.policy = ThreadSettings::Policy::Nice;
+	}
+	settings.priority = node["priority"].as<int>(settings.priority);
+	return settings;
+}
+
+// how Engine::readConfig read the config before it had a schema
+void legacyParseConfig(YAML::Node yamlConfig, EngineConfig& config) {
+	config.name = yamlConfig["name"].as<std::string>("game");
+	config.width = yamlConfig["width"].as<uint32_t>(config.width);
+	config.height = yamlConfig["height"].as<uint32_t>(config.height);
+	config.fullscreen = yamlConfig["fullscreen"].as<bool>(config.fullscreen);
+	config.useDesktopSize = yamlConfig["useDesktopSize"].as<bool>(config.useDesktopSize);
+	config.vsync = yamlConfig["vsync"].as<bool>(config.vsync);
+	config.deadZone = yamlConfig["deadzone"].as<float>(config.deadZone);
+	config.keySpeed = yamlConfig["keySpeed"].as<float>(config.keySpeed);
+	config.rewindSeconds = yamlConfig["rewindSeconds"].as<float>(config.rewindSeconds);
+	config.targetFps = yamlConfig["targetFps"].as<uint32_t>(config.targetFps);
+	config.justInTime = yamlConfig["justInTime"].as<bool>(config.justInTime);
+	config.jitMargin = yamlConfig["jitMargin"].as<float>(config.jitMargin);
+	YAML::Node threadsNode = yamlConfig["threads"];
+	config.threads.main = legacyThreadSettings(threadsNode["main"], config.threads.main);
+	config.threads.simulation = legacyThreadSettings(threadsNode["simulation"], config.threads.simulation);
+	config.threads.render = legacyThreadSettings(threadsNode["render"], config.threads.render);
+	config.threads.worker = legacyThreadSettings(threadsNode["worker"], config.threads.worker);
+	config.threads.client = legacyThreadSettings(threadsNode["client"], config.threads.client);
+	config.threads.streamer = legacyThreadSettings(threadsNode["streamer"], config.threads.streamer);
+	YAML::Node streamingNode = yamlConfig["streaming"];
+	config.streaming.memoryCap = streamingNode["memoryCap"].as<float>(config.streaming.memoryCap);
+	config.streaming.prefetchWaves = streamingNode["prefetchWaves"].as<uint32_t>(config.streaming.prefetchWaves);
+	YAML::Node networkNode = yamlConfig["network"];
+	config.network.enabled = networkNode["enabled"].as<bool>(config.network.enabled);
+	config.network.port = networkNode["port"].as<unsigned short>(config.network.port);
+	config.network.conditions.latency = networkNode["latency"].as<float>(config.network.conditions.latency);
+	config.network.conditions.jitter = networkNode["jitter"].as<float>(config.network.conditions.jitter);
+	config.network.conditions.loss = networkNode["loss"].as<float>(config.network.conditions.loss);
+	config.network.snapshotInterval = networkNode["snapshotInterval"].as<uint32_t>(config.network.snapshotInterval);
+	config.network.inputRedundancy = networkNode["inputRedundancy"].as<uint32_t>(config.network.inputRedundancy);
+	config.network.interpolationDelay = networkNode["interpolationDelay"].as<float>(config.network.interpolationDelay);
+	YAML::Node budgetsNode = yamlConfig["memoryBudgets"];
+	for (size_t tag = 0; tag < ALLOCATION_TAG_COUNT; tag++) {
+		const char* tagName = allocationTagToString(static_cast<AllocationTag>(tag));
+		config.memoryBudgets[tag] = budgetsNode[tagName].as<float>(config.memoryBudgets[tag]);
+	}
+}
+
+void schemaParseConfig(const YAML::Node& yamlConfig, EngineConfig& config) {
+	config.name = "game";
+	SchemaErrors errors;
+	parseEngineConfig(yamlConfig, config, SchemaPath{nullptr, "config.yaml"}, errors);
+}
+
+// every run starts from a fresh copy of the output, so only the parsing itself is counted
+template <typename T, typename Function>
+Result measure(const uint32_t iterations, const T& fresh, T& output, Function&& function) {
+	Result result;
+	for (uint32_t i = 0; i < iterations; i++) {
+		output = fresh;
+		const uint64_t allocationStart = threadAllocationCount();
+		const uint64_t byteStart = threadAllocationBytes();
+		const auto start = std::chrono::steady_clock::now();
+		function(output);
+		result.time += std::chrono::steady_clock::now() - start;
+		result.allocations += threadAllocationCount() - allocationStart;
+		result.bytes += threadAllocationBytes() - byteStart;
+	}
+	return result;
+}
+
+void printResult(const char* name, const Result& legacy, const Result& schema, const uint32_t iterations) {
+	const auto perIteration = [iterations](const uint64_t value) {
+		return static_cast<double>(value) / iterations;
+	};
+	std::cout << "\"" << name << "\": {"
+		<< "\"legacyUs\": " << perIteration(static_cast<uint64_t>(legacy.time.count())) / 1e3 << ", "
+		<< "\"schemaUs\": " << perIteration(static_cast<uint64_t>(schema.time.count())) / 1e3 << ", "
+		<< "\"speedup\": " << static_cast<double>(legacy.time.count()) / static_cast<double>(std::max<int64_t>(1, schema.time.count())) << ", "
+		<< "\"legacyAllocations\": " << perIteration(legacy.allocations) << ", "
+		<< "\"schemaAllocations\": " << perIteration(schema.allocations) << ", "
+		<< "\"legacyBytes\": " << perIteration(legacy.bytes) << ", "
+		<< "\"schemaBytes\": " << perIteration(schema.bytes)
+		<< "}";
+}
+
+}
+
+int main(const int argc, const char** argv) {
+	const uint32_t vertexCount = argc > 1 ? static_cast<uint32_t>(std::stoul(argv[1])) : 20000;
+	const uint32_t iterations = std::max(1u, argc > 2 ? static_cast<uint32_t>(std::stoul(argv[2])) : 20u);
+	// the config is tiny, so run it enough times to measure
+	const uint32_t configIterations = iterations * 100;
+
+	const std::string& spriteText = makeSpriteDefinition(vertexCount);
+	const auto loadStart = std::chrono::steady_clock::now();
+	const YAML::Node sprite = YAML::Load(spriteText);
+	const std::chrono::nanoseconds loadTime = std::chrono::steady_clock::now() - loadStart;
+
+	uint64_t mismatches = 0;
+
+	Geometry fresh;
+	fresh.vertices.reserve(vertexCount);
+	Geometry legacyGeometry;
+	Geometry schemaGeometry;
+	const Result legacySprite = measure(iterations, fresh, legacyGeometry, [&sprite, &mismatches](Geometry& geometry) {
+		mismatches += legacyParseSprite(sprite, geometry) ? 0 : 1;
+	});
+	const Result schemaSprite = measure(iterations, fresh, schemaGeometry, [&sprite, &mismatches](Geometry& geometry) {
+		mismatches += schemaParseSprite(sprite, geometry) ? 0 : 1;
+	});
+	if (legacyGeometry.vertices.size() != schemaGeometry.vertices.size()
+		|| legacyGeometry.size != schemaGeometry.size || legacyGeometry.behavior != schemaGeometry.behavior) {
+		mismatches++;
+	} else {
+		for (size_t i = 0; i < legacyGeometry.vertices.size(); i++) {
+			const sf::Vertex& a = legacyGeometry.vertices[i];
+			const sf::Vertex& b = schemaGeometry.vertices[i];
+			if (a.position != b.position || a.color != b.color) {
+				mismatches++;
+				break;
+			}
+		}
+	}
+
+	const YAML::Node config = YAML::LoadFile("game/config.yaml");
+	const EngineConfig defaults;
+	EngineConfig legacyConfig;
+	EngineConfig schemaConfig;
+	const Result legacyConfigResult = measure(configIterations, defaults, legacyConfig, [&config](EngineConfig& output) {
+		legacyParseConfig(config, output);
+	});
+	const Result schemaConfigResult = measure(configIterations, defaults, schemaConfig, [&config](EngineConfig& output) {
+		schemaParseConfig(config, output);
+	});
+	if (legacyConfig.width != schemaConfig.width || legacyConfig.network.port != schemaConfig.network.port
+		|| legacyConfig.memoryBudgets[1] != schemaConfig.memoryBudgets[1] || legacyConfig.name != schemaConfig.name) {
+		mismatches++;
+	}
+
+	std::cout << "{\"benchmark\": \"parse\", "
+		<< "\"vertices\": " << vertexCount << ", "
+		<< "\"iterations\": " << iterations << ", "
+		<< "\"yamlBytes\": " << spriteText.size() << ", "
+		<< "\"yamlLoadUs\": " << static_cast<double>(loadTime.count()) / 1e3 << ", ";
+	printResult("sprite", legacySprite, schemaSprite, iterations);
+	std::cout << ", ";
+	printResult("config", legacyConfigResult, schemaConfigResult, configIterations);
+	std::cout << ", \"mismatches\": " << mismatches << "}" << std::endl;
+	return mismatches == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,169 @@
+/*
+ * World snapshot benchmark
+ *
+ * Simulates a crowd of moving entities and reports, as JSON, the encoded
+ * size and the encode/decode speed of key frames, deltas and the rewind history.
+ *
+ * usage: jage_bench_snapshot [entities] [ticks]
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <string>
+
+#include <Snapshot.hpp>
+#include <memory.hpp>
+
+using namespace std::chrono_literals;
+
+namespace {
+
+struct Body {
+	float x;
+	float y;
+	float rotation;
+	float velocityX;
+	float velocityY;
+	float speed;
+};
+
+double toMicroseconds(const std::chrono::nanoseconds& time, const uint32_t count) {
+	return static_cast<double>(time.count()) / count / 1e3;
+}
+
+}
+
+int main(const int argc, const char** argv) {
+	const uint32_t entityCount = argc > 1 ? static_cast<uint32_t>(std::stoul(argv[1])) : 10000;
+	const uint32_t ticks = std::max(2u, argc > 2 ? static_cast<uint32_t>(std::stoul(argv[2])) : 600u);
+	const float tickSeconds = 1.0f / 120.0f;
+
+	// everything moving, the worst case for deltas, with a few sitting still
+	std::vector<Body> bodies(entityCount);
+	for (uint32_t i = 0; i < entityCount; i++) {
+		const float angle = static_cast<float>(i) * 2.39996323f;
+		bodies[i] = {
+			static_cast<float>(i % 128) * 10.0f,
+			static_cast<float>(i / 128) * 10.0f,
+			0.0f,
+			i % 10 == 0 ? 0.0f : std::cos(angle) * 30.0f,
+			i % 10 == 0 ? 0.0f : std::sin(angle) * 30.0f,
+			10.0f
+		};
+	}
+
+	auto capture = [&bodies](const uint32_t tick, WorldSnapshot& snapshot) {
+		snapshot.tick = tick;
+		snapshot.entities.resize(bodies.size());
+		for (size_t i = 0; i < bodies.size(); i++) {
+			const Body& body = bodies[i];
+			snapshot.entities[i] = {
+				static_cast<uint32_t>(i),
+				quantizePosition(body.x),
+				quantizePosition(body.y),
+				quantizeRotation(body.rotation),
+				quantizeVelocity(body.velocityX),
+				quantizeVelocity(body.velocityY),
+				quantizeSpeed(body.speed)
+			};
+		}
+	};
+
+	SnapshotCodec encoder;
+	SnapshotCodec decoder;
+	SnapshotHistory history(ticks);
+	WorldSnapshot previous;
+	WorldSnapshot current;
+	WorldSnapshot decoded;
+	std::vector<uint8_t> keyFrame;
+	std::vector<uint8_t> deltaFrame;
+
+	std::chrono::nanoseconds keyEncodeTime = 0ns;
+	std::chrono::nanoseconds deltaEncodeTime = 0ns;
+	std::chrono::nanoseconds deltaDecodeTime = 0ns;
+	std::chrono::nanoseconds captureTime = 0ns;
+	uint64_t keyBytes = 0;
+	uint64_t deltaBytes = 0;
+	uint64_t mismatches = 0;
+	uint64_t allocations = 0;
+
+	capture(0, previous);
+	history.capture(previous);
+	for (uint32_t tick = 1; tick < ticks; tick++) {
+		for (auto& body : bodies) {
+			body.x += body.velocityX * body.speed * tickSeconds;
+			body.y += body.velocityY * body.speed * tickSeconds;
+			body.rotation += body.velocityX * tickSeconds;
+		}
+		capture(tick, current);
+		const uint64_t allocationStart = threadAllocationCount();
+
+		auto start = std::chrono::steady_clock::now();
+		encoder.encode(current, nullptr, keyFrame);
+		keyEncodeTime += std::chrono::steady_clock::now() - start;
+		keyBytes += keyFrame.size();
+
+		start = std::chrono::steady_clock::now();
+		encoder.encode(current, &previous, deltaFrame);
+		deltaEncodeTime += std::chrono::steady_clock::now() - start;
+		deltaBytes += deltaFrame.size();
+
+		start = std::chrono::steady_clock::now();
+		if (!decoder.decode(deltaFrame.data(), deltaFrame.size(), &previous, decoded)) {
+			mismatches++;
+		}
+		deltaDecodeTime += std::chrono::steady_clock::now() - start;
+
+		// the first couple of ticks size the scratch buffers
+		if (tick > 2) {
+			allocations += threadAllocationCount() - allocationStart;
+		}
+
+		// not counted above, every history slot allocates the first time around the ring
+		start = std::chrono::steady_clock::now();
+		history.capture(current);
+		captureTime += std::chrono::steady_clock::now() - start;
+
+		for (size_t i = 0; i < current.entities.size(); i++) {
+			if (decoded.entities[i].x != current.entities[i].x || decoded.entities[i].y != current.entities[i].y) {
+				mismatches++;
+				break;
+			}
+		}
+		std::swap(previous, current);
+	}
+
+	// walk the whole history back to the start
+	const auto rewindStart = std::chrono::steady_clock::now();
+	uint32_t rewound = 0;
+	while (history.rewind(decoded)) {
+		rewound++;
+	}
+	const std::chrono::nanoseconds rewindTime = std::chrono::steady_clock::now() - rewindStart;
+	if (decoded.tick != 0) {
+		mismatches++;
+	}
+
+	const uint32_t frames = ticks - 1;
+	const double rawBytes = static_cast<double>(entityCount) * sizeof(EntityState);
+	std::cout << "{\"benchmark\": \"snapshot\", "
+		<< "\"entities\": " << entityCount << ", "
+		<< "\"ticks\": " << ticks << ", "
+		<< "\"rawBytes\": " << rawBytes << ", "
+		<< "\"keyFrameBytes\": " << static_cast<double>(keyBytes) / frames << ", "
+		<< "\"deltaBytes\": " << static_cast<double>(deltaBytes) / frames << ", "
+		<< "\"keyEncodeUs\": " << toMicroseconds(keyEncodeTime, frames) << ", "
+		<< "\"deltaEncodeUs\": " << toMicroseconds(deltaEncodeTime, frames) << ", "
+		<< "\"deltaDecodeUs\": " << toMicroseconds(deltaDecodeTime, frames) << ", "
+		<< "\"deltaEncodeMBps\": " << rawBytes * frames / (static_cast<double>(deltaEncodeTime.count()) / 1e9) / 1e6 << ", "
+		<< "\"deltaDecodeMBps\": " << rawBytes * frames / (static_cast<double>(deltaDecodeTime.count()) / 1e9) / 1e6 << ", "
+		<< "\"historyCaptureUs\": " << toMicroseconds(captureTime, frames) << ", "
+		<< "\"historyRewindUs\": " << toMicroseconds(rewindTime, std::max(1u, rewound)) << ", "
+		<< "\"historyTicksRewound\": " << rewound << ", "
+		<< "\"codecAllocationsPerTick\": " << static_cast<double>(allocations) / (frames > 2 ? frames - 2 : 1) << ", "
+		<< "\"mismatches\": " << mismatches
+		<< "}" << std::endl;
+	return mismatches == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// bump allocator for short-lived scratch data, everything is freed at once by reset()
+class Arena {
+public:
+	// where the arena was at some point, for rewinding back to it
+	struct Marker {
+		size_t block;
+		size_t offset;
+	};
+
+	explicit Arena(size_t initialSize = 64 * 1024);
+	~Arena();
+
+	Arena(const Arena&) = delete;
+	Arena& operator=(const Arena&) = delete;
+
+	void* allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+	// only gives the memory back if it was the most recent allocation
+	void deallocate(void* memory, size_t size);
+
+	// drop everything, once warmed up this never touches the heap
+	void reset();
+
+	Marker getMarker() const;
+	void rewind(const Marker& marker);
+
+	size_t getUsed() const;
+	size_t getCapacity() const;
+
+private:
+	struct Block {
+		char* data;
+		size_t size;
+	};
+
+	void addBlock(size_t minimumSize);
+
+	std::vector<Block> blocks;
+	size_t currentBlock = 0;
+	size_t offset = 0;
+};
+
+// the calling thread's arena, reset by the loop that owns the thread
+Arena& frameArena();
+
+// rewinds an arena when it goes out of scope, for scratch data outside a frame
+class ArenaScope {
+public:
+	explicit ArenaScope(Arena& _arena) : arena(_arena), marker(_arena.getMarker()) {}
+	~ArenaScope() {
+		arena.rewind(marker);
+	}
+
+	ArenaScope(const ArenaScope&) = delete;
+	ArenaScope& operator=(const ArenaScope&) = delete;
+
+private:
+	Arena& arena;
+	Arena::Marker marker;
+};
+
+// standard allocator interface on top of an Arena, so containers can use one
+template <typename T>
+class ArenaAllocator {
+public:
+	using value_type = T;
+
+	explicit ArenaAllocator(Arena& _arena) noexcept : arena(&_arena) {}
+
+	template <typename U>
+	ArenaAllocator(const ArenaAllocator<U>& other) noexcept : arena(other.getArena()) {}
+
+	T* allocate(size_t count) {
+		return static_cast<T*>(arena->allocate(count * sizeof(T), alignof(T)));
+	}
+
+	void deallocate(T* memory, size_t count) noexcept {
+		arena->deallocate(memory, count * sizeof(T));
+	}
+
+	Arena* getArena() const noexcept {
+		return arena;
+	}
+
+private:
+	Arena* arena;
+};
+
+template <typename T, typename U>
+bool operator==(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) noexcept {
+	return a.getArena() == b.getArena();
+}
+
+template <typename T, typename U>
+bool operator!=(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) noexcept {
+	return !(a == b);
+}
+
+template <typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
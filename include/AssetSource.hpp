@@ -0,0 +1,30 @@
+#pragma once
+
+#include <string>
+
+#include <yaml-cpp/yaml.h>
+
+#include <Pack.hpp>
+
+// where a game's data files come from: its pack file if there is one, loose files otherwise
+class AssetSource {
+public:
+	// use packFile, or <dataDir>.jpak when it's empty, falling back to the files in dataDir
+	// when there's no pack or any of its files has been edited since it was built
+	void open(const std::string& _dataDir, const std::string& packFile = "");
+	bool isPacked() const;
+	// the pack or directory, for logging
+	std::string getLocation() const;
+
+	// parse a YAML file, throws YAML::Exception when it can't, like YAML::LoadFile
+	// safe to call from several threads at once
+	YAML::Node loadYAML(const std::string& name) const;
+
+private:
+	// true if a loose copy of anything in the pack is newer than the pack
+	bool isPackStale(const std::string& packFile) const;
+
+	std::string dataDir;
+	std::string packFileName;
+	PackFile pack;
+};
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <AssetSource.hpp>
+#include <Sprite.hpp>
+#include <threading.hpp>
+
+// loads sprite definitions on a background thread ahead of when they're needed,
+// and drops the least recently used ones when over the memory cap
+class AssetStreamer {
+public:
+	struct Stats {
+		uint64_t loads = 0;
+		uint64_t failures = 0;
+		uint64_t evictions = 0;
+		size_t bytes = 0;
+		size_t peakBytes = 0;
+		// total time spent loading, in milliseconds
+		float loadTime = 0.0f;
+	};
+
+	AssetStreamer(const AssetSource& _source, size_t _memoryCap, const ThreadSettings& settings);
+	~AssetStreamer();
+	AssetStreamer(const AssetStreamer&) = delete;
+	AssetStreamer& operator=(const AssetStreamer&) = delete;
+
+	// start loading in the background, unless it's loaded, on its way or failed already
+	void prefetch(const std::string& name);
+	// the loaded sprite to copy, or null if it isn't ready yet, never waits
+	std::shared_ptr<const Sprite> find(const std::string& name);
+	// true if it was tried and can't be loaded, so there's no point waiting for it
+	bool hasFailed(const std::string& name) const;
+	// keep these loaded no matter what, replacing the previous set
+	void pin(const std::vector<std::string>& names);
+
+	Stats getStats() const;
+
+private:
+	enum class State {
+		Queued,
+		Loading,
+		Ready,
+		Failed,
+		// was ready, but dropped to stay under the cap
+		Evicted
+	};
+
+	struct Asset {
+		State state = State::Queued;
+		std::shared_ptr<const Sprite> sprite;
+		size_t bytes = 0;
+		// when it was last found, for picking what to evict
+		uint64_t lastUse = 0;
+		bool pinned = false;
+	};
+
+	void threadFunc(ThreadSettings settings);
+	// drop unpinned sprites, oldest first, until under the cap, call with the mutex locked
+	void evict();
+
+	const AssetSource& source;
+	const size_t memoryCap;
+
+	std::map<std::string, Asset> assets;
+	std::deque<std::string> queue;
+	uint64_t useClock = 0;
+	bool stopping = false;
+	Stats stats;
+
+	mutable std::mutex mutex;
+	std::condition_variable queueChanged;
+	std::thread thread;
+};
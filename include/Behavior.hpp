@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <yaml-cpp/yaml.h>
+
+// one step of a compiled behavior, what the parameters mean depends on the op
+enum class BehaviorOp : uint8_t {
+	// a: weight
+	Seek,
+	// a: weight, b: radius
+	Flee,
+	// a: weight, b: frequency in Hz
+	Wander,
+	// a: weight, b: radius, c: 1 for clockwise, -1 for counter-clockwise
+	Orbit,
+	// a: weight, b: spacing, c: columns, d: distance in front of the target
+	Formation,
+	// a: interval in seconds, b: shots per volley, c: spread in degrees, d: aimed if non-zero
+	Fire
+};
+
+struct BehaviorInstruction {
+	BehaviorOp op;
+	float a;
+	float b;
+	float c;
+	float d;
+};
+
+struct BehaviorProgram {
+	std::string name;
+	// longest velocity direction the steering can produce, same units as the player's
+	float maxSpeed = 30.0f;
+	std::vector<BehaviorInstruction> code;
+};
+
+// all the behaviors in a game, compiled from YAML
+class BehaviorLibrary {
+public:
+	bool loadFromYAML(const std::string& fileName);
+	bool loadFromNode(const YAML::Node& node);
+
+	// nullptr if there's no behavior with that name
+	const BehaviorProgram* find(const std::string& name) const;
+	size_t size() const;
+
+private:
+	static bool compileStep(const YAML::Node& step, BehaviorInstruction& instruction);
+
+	std::map<std::string, BehaviorProgram> programs;
+};
+
+// a shot requested by a fire step
+struct FireEvent {
+	uint32_t ship;
+	float x;
+	float y;
+	float dirX;
+	float dirY;
+};
+
+// every ship running the same behavior, laid out as parallel arrays so each
+// step runs as one tight loop over the whole batch
+class BehaviorBatch {
+public:
+	explicit BehaviorBatch(const BehaviorProgram& _program);
+
+	// returns the new ship's index in the arrays
+	uint32_t add(float x, float y);
+	// the last ship moves into the removed one's place, keeping its own offsets
+	void remove(uint32_t index);
+	size_t size() const;
+	const BehaviorProgram& getProgram() const;
+
+	// run the program once for every ship, reading positions and writing directions
+	void evaluate(float elapsedSeconds, float targetX, float targetY);
+
+	// positions, filled in before evaluate()
+	std::vector<float> x;
+	std::vector<float> y;
+	// resulting velocity directions
+	std::vector<float> dirX;
+	std::vector<float> dirY;
+	// shots fired by the last evaluate()
+	std::vector<FireEvent> fired;
+
+private:
+	const BehaviorProgram& program;
+	float time = 0.0f;
+	// per ship offsets, so identical ships don't move in lockstep
+	std::vector<float> phase;
+	std::vector<float> fireTimer;
+};
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <Network.hpp>
+#include <Snapshot.hpp>
+#include <Sprite.hpp>
+
+// the player's end of a local game: sends input, predicts the player's own
+// ship and interpolates everything else between server snapshots
+class GameClient {
+public:
+	struct Stats {
+		uint64_t snapshotsReceived = 0;
+		uint64_t snapshotsRejected = 0;
+		float lastRoundTrip = 0.0f;
+		float totalRoundTrip = 0.0f;
+		float maxRoundTrip = 0.0f;
+		uint64_t predictionChecks = 0;
+		float totalPredictionError = 0.0f;
+		float maxPredictionError = 0.0f;
+	};
+
+	GameClient(
+		unsigned short serverPort,
+		const NetworkConditions& conditions,
+		const std::vector<std::shared_ptr<Sprite>>& serverSprites,
+		uint32_t _playerId,
+		std::chrono::nanoseconds _tickDuration,
+		uint32_t _interpolationTicks,
+		uint32_t _inputRedundancy
+	);
+
+	bool isConnected() const;
+
+	// one client tick: apply snapshots, predict the player, interpolate the rest, send input
+	void tick(float x, float y);
+
+	// the client's own copies of the sprites, lock the mutex while drawing them
+	const std::vector<std::shared_ptr<Sprite>>& getSprites() const;
+	std::mutex& getSpritesMutex();
+
+	const Stats& getStats() const;
+	const ChannelStats& getChannelStats() const;
+
+private:
+	struct PredictedInput {
+		InputRecord input;
+		// where the player ended up after this input, as far as the client knows
+		sf::Vector2f position;
+	};
+
+	void receiveSnapshots();
+	// move the player to where the server says, then replay the inputs it hasn't seen yet
+	void reconcile(uint32_t processedSequence, uint32_t repeatedTicks, const WorldSnapshot& snapshot);
+	void applyInput(const InputRecord& input);
+	void interpolate();
+	uint32_t now() const;
+
+	UdpChannel channel;
+	bool connected;
+	SnapshotCodec codec;
+	std::chrono::steady_clock::time_point startTime;
+
+	std::vector<std::shared_ptr<Sprite>> sprites;
+	std::mutex spritesMutex;
+	uint32_t playerId;
+	std::chrono::nanoseconds tickDuration;
+	uint32_t interpolationTicks;
+	uint32_t inputRedundancy;
+
+	// recent inputs by sequence, for resending and replaying
+	std::vector<PredictedInput> inputHistory;
+	uint32_t nextSequence = 1;
+
+	// recent snapshots by tick, as delta baselines and interpolation points
+	std::vector<WorldSnapshot> snapshots;
+	WorldSnapshot decoded;
+	uint32_t newestTick = NO_TICK;
+	// the server tick being shown, a little behind the newest so there's something to blend towards
+	float renderTick = 0.0f;
+
+	std::vector<uint8_t> packet;
+	std::vector<InputRecord> outgoing;
+
+	Stats stats;
+};
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include <yaml-cpp/yaml.h>
+
+#include <Network.hpp>
+#include <Schema.hpp>
+#include <memory.hpp>
+#include <threading.hpp>
+
+// everything config.yaml can set, with the defaults used for whatever it leaves out
+struct EngineConfig {
+	// naming, pinning and scheduling for each kind of thread
+	struct Threads {
+		ThreadSettings main = ThreadSettings("jage-main");
+		ThreadSettings simulation = ThreadSettings("jage-sim");
+		ThreadSettings render = ThreadSettings("jage-render");
+		ThreadSettings worker = ThreadSettings("jage-worker");
+		ThreadSettings client = ThreadSettings("jage-client");
+		ThreadSettings streamer = ThreadSettings("jage-stream");
+	};
+
+	// background loading of upcoming waves
+	struct Streaming {
+		// most loaded sprite definitions to keep, in MiB
+		float memoryCap = 4.0f;
+		// how many waves ahead to load
+		uint32_t prefetchWaves = 1;
+	};
+
+	// run the simulation as a server & talk to it over localhost
+	struct Network {
+		bool enabled = false;
+		unsigned short port = 47200;
+		// injected one-way delay & packet loss, for trying out bad connections
+		NetworkConditions conditions;
+		// send the world every this many ticks
+		uint32_t snapshotInterval = 2;
+		// how many recent inputs each input packet carries
+		uint32_t inputRedundancy = 8;
+		// how far behind the server the client shows other entities, in milliseconds
+		float interpolationDelay = 100.0f;
+	};
+
+	std::string name;
+	// this size fits in most screens in windowed mode
+	unsigned int width = 1200;
+	unsigned int height = 675;
+	// don't start fullscreen
+	bool fullscreen = false;
+	// but do use desktop size when going fullscreen
+	bool useDesktopSize = true;
+	bool vsync = true;
+	// frame pacing, 0 fps leaves it all up to v-sync
+	uint32_t targetFps = 60;
+	// sample the world just before presenting, to cut input latency
+	bool justInTime = false;
+	// how early to start a just-in-time frame, on top of its measured render time
+	float jitMargin = 1.0f;
+	Threads threads;
+	// live heap budget for each allocation tag in MiB, 0 for no limit
+	float memoryBudgets[ALLOCATION_TAG_COUNT] = {};
+	// how far back holding the rewind key can go
+	float rewindSeconds = 10.0f;
+	Streaming streaming;
+	Network network;
+	// controller/keyboard settings
+	float deadZone = 15.0;
+	float keySpeed = 75.0;
+};
+
+// read the whole config in one pass, keeping the defaults for anything missing or wrong,
+// every unknown key & bad value ends up in errors
+bool parseEngineConfig(const YAML::Node& node, EngineConfig& config, const SchemaPath& path, SchemaErrors& errors);
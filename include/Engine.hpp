@@ -1,7 +1,10 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <cmath>
+#include <condition_variable>
 #include <mutex>
 #include <thread>
 
@@ -20,7 +23,20 @@
 #include <SFML/Graphics.hpp>
 #include <yaml-cpp/yaml.h>
 
+#include <FramePacer.hpp>
+#include <memory.hpp>
+#include <Arena.hpp>
+#include <AssetSource.hpp>
+#include <AssetStreamer.hpp>
+#include <Behavior.hpp>
+#include <Client.hpp>
+#include <Config.hpp>
+#include <Server.hpp>
+#include <Snapshot.hpp>
 #include <Sprite.hpp>
+#include <Startup.hpp>
+#include <threading.hpp>
+#include <Wave.hpp>
 
 using namespace std::chrono_literals;
 
@@ -43,12 +59,40 @@ public:
 private:
 	/* methods */
 
+	// block the calling thread until run() starts the game
+	void waitUntilRunning();
+
 	//event dispatcher
 	void processEvents();
 	// update the simulation
 	void simulationThreadFunc();
 	// render everything, runs in separate thread
 	void renderThreadFunc();
+	// send input to the server & predict, runs in separate thread when networked
+	void clientThreadFunc();
+
+	// current joystick/keyboard direction, with the dead zone applied
+	sf::Vector2f readControls() const;
+
+	// add a sprite to the world under the next entity id, call with the sprites locked
+	void addToWorld(const std::shared_ptr<Sprite>& sprite);
+	// take ships out of the world and their behavior batches, call with the sprites locked
+	void removeFromWorld(const ArenaVector<const Sprite*>& ships);
+
+	// put an enemy under the control of its behavior
+	void addEnemy(const std::shared_ptr<Sprite>& ship);
+	// run every enemy behavior once, call with the sprites locked
+	void updateEnemies(const std::chrono::nanoseconds& elapsed);
+
+	// start the next wave when it's due and its assets are in, despawning the last one's ships
+	// and any that flew off the screen, call with the sprites locked
+	void updateWaves(const std::chrono::nanoseconds& elapsed);
+	// load these waves' assets in the background, and keep them and the current wave's loaded
+	void streamWaves(size_t first);
+
+	// copy every sprite's state into a snapshot and back, call with the sprites locked
+	void captureWorld(uint32_t tick, WorldSnapshot& snapshot) const;
+	void restoreWorld(const WorldSnapshot& snapshot);
 
 	// event handlers
 	void handleResize(const sf::Event::SizeEvent& newSize);
@@ -57,6 +101,12 @@ private:
 
 	// log some build & system info
 	void dumpSystemInfo() const;
+	// log heap usage for each subsystem
+	void dumpMemoryStats() const;
+	// warn when a subsystem goes over its memory budget
+	void checkMemoryBudgets();
+	// log bandwidth, round trips and prediction error for a networked game
+	void dumpNetworkStats(float seconds) const;
 
 	// get the configuration from an INI file
 	void readConfig();
@@ -66,40 +116,48 @@ private:
 	// change the viewport to maintain 16:9 aspect ratio
 	void adjustAspect(const sf::Vector2u& newSize);
 
+	// one sprite to draw this frame, and where, holding on to it so a despawn can't free it mid-draw
+	struct DrawCommand {
+		std::shared_ptr<const Sprite> sprite;
+		sf::Transform transform;
+	};
+
+	// enemies sharing a behavior, evaluated together each tick
+	struct EnemyGroup {
+		std::unique_ptr<BehaviorBatch> batch;
+		std::vector<std::shared_ptr<Sprite>> ships;
+	};
+
 	/* member data */
 
 	int argc;
 	const char** argv;
 
+	// when the constructor started, for timing startup & the first frame
+	std::chrono::steady_clock::time_point startupTime;
+
 	std::chrono::high_resolution_clock engineClock;
 
 	std::unique_ptr<std::thread> updateThread;
 	std::unique_ptr<std::thread> renderThread;
+	std::unique_ptr<std::thread> clientThread;
 
 	bool isReady = false;
-	bool running = false;
+	// read by every thread, and waited on through runningChanged before the game starts
+	std::atomic<bool> running{false};
+	std::mutex runningMutex;
+	std::condition_variable runningChanged;
 
 	std::string game;
 	std::string data_dir;
+	// empty for <game>.jpak
+	std::string packFile;
 
 	// render internally to 720p widescreen
 	unsigned int renderWidth = 1280;
 	unsigned int renderHeight = 720;
 
-	struct {
-		std::string name;
-		// this size fits in most screens in windowed mode
-		unsigned int width = 1200;
-		unsigned int height = 675;
-		// don't start fullscreen
-		bool fullscreen = false;
-		// but do use desktop size when going fullscreen
-		bool useDesktopSize = true;
-		bool vsync = true;
-		// controller/keyboard settings
-		float deadZone = 15.0;
-		float keySpeed = 75.0;
-	} config;
+	EngineConfig config;
 
 	// where everything is drawn
 	sf::RenderWindow window;
@@ -110,11 +168,51 @@ private:
 	std::mutex windowMutex;
 	std::mutex spritesMutex;
 
+	// which subsystems were over budget at the last check, so each overrun warns once
+	bool overBudget[ALLOCATION_TAG_COUNT] = {};
+
 	// all normal sprites to draw
 	std::vector<std::shared_ptr<Sprite>> sprites;
+	// each sprite's id in snapshots, ids only grow and despawning keeps the order, so these stay sorted
+	std::vector<uint32_t> entityIds;
+	uint32_t nextEntityId = 0;
 
 	// the player's ship sprite
 	std::shared_ptr<Sprite> player;
 	// computer opponent's ship sprite
 	std::shared_ptr<Sprite> enemy;
+
+	// recent world states for rewinding, used only by the simulation thread
+	std::unique_ptr<SnapshotHistory> history;
+
+	// both ends of a networked game, null when playing locally
+	std::unique_ptr<GameServer> server;
+	std::unique_ptr<GameClient> client;
+
+	// the game's data files, from its pack when there is one
+	AssetSource assets;
+	// sprite definitions for upcoming waves, loaded in the background
+	std::unique_ptr<AssetStreamer> streamer;
+
+	// the level, used only by the simulation thread once the game starts
+	// rewinding only moves ships, it never steps back through waves, so rewinding past a wave's
+	// start leaves nextWave and waveTimer alone and its ships in place, and despawned ships stay gone
+	std::vector<Wave> waves;
+	size_t nextWave = 0;
+	// time left until the next wave is due
+	std::chrono::nanoseconds waveTimer = 0ns;
+	// ships from the wave in play, despawned when its time is up
+	std::vector<std::shared_ptr<Sprite>> waveShips;
+	// the due wave is waiting on its assets, since this time
+	bool waveDeferred = false;
+	std::chrono::steady_clock::time_point waveDeferredSince;
+	// whether each wave's assets were ready by the time it was due
+	uint64_t prefetchHits = 0;
+	uint64_t prefetchMisses = 0;
+
+	// compiled enemy AI
+	BehaviorLibrary behaviors;
+	std::vector<EnemyGroup> enemyGroups;
+	// shots requested by enemy behaviors, there are no projectiles yet
+	uint64_t enemyShotsFired = 0;
 };
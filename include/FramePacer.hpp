@@ -0,0 +1,64 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+using namespace std::chrono_literals;
+
+// paces a render loop against absolute present deadlines
+class FramePacer {
+public:
+	// steady, unlike high_resolution_clock on some platforms, so deadlines never jump
+	using clock = std::chrono::steady_clock;
+
+	struct Stats {
+		uint64_t frames = 0;
+		uint64_t missedDeadlines = 0;
+		std::chrono::nanoseconds minInterval = std::chrono::nanoseconds::max();
+		std::chrono::nanoseconds maxInterval = 0ns;
+		std::chrono::nanoseconds totalInterval = 0ns;
+
+		std::chrono::nanoseconds averageInterval() const;
+	};
+
+	// targetFps of 0 doesn't wait at all, just measures
+	FramePacer(
+		uint32_t targetFps,
+		bool justInTime,
+		std::chrono::nanoseconds jitMargin = 1ms,
+		std::chrono::nanoseconds spinThreshold = 2ms
+	);
+
+	// block until it's time to sample the world and draw the next frame
+	void waitToRender();
+	// call right after the frame was presented
+	void presented();
+
+	// stats since the pacer started, and since the last takeIntervalStats()
+	const Stats& getTotalStats() const;
+	Stats takeIntervalStats();
+
+	std::chrono::nanoseconds getFramePeriod() const;
+	std::chrono::nanoseconds getRenderEstimate() const;
+
+private:
+	// sleep for most of the wait, then spin out the rest for accuracy
+	void waitUntil(const clock::time_point& wakeTime) const;
+	void record(Stats& stats, const std::chrono::nanoseconds& interval, bool missed);
+
+	const std::chrono::nanoseconds framePeriod;
+	const bool justInTime;
+	const std::chrono::nanoseconds jitMargin;
+	const std::chrono::nanoseconds spinThreshold;
+
+	bool started = false;
+	clock::time_point deadline;
+	clock::time_point renderStart;
+	clock::time_point lastPresent;
+	// smoothed time from sampling the world to the present returning
+	std::chrono::nanoseconds renderEstimate = 0ns;
+
+	Stats totalStats;
+	Stats intervalStats;
+};
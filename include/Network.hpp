@@ -0,0 +1,121 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include <SFML/Network.hpp>
+
+// simulated network trouble, applied to everything a channel sends
+struct NetworkConditions {
+	// one way, in milliseconds
+	float latency = 0.0f;
+	// random extra delay on top of the latency, in milliseconds
+	float jitter = 0.0f;
+	// chance of dropping each packet, 0 to 1
+	float loss = 0.0f;
+};
+
+struct ChannelStats {
+	uint64_t packetsSent = 0;
+	uint64_t packetsReceived = 0;
+	// lost to the simulated conditions or a full delay queue
+	uint64_t packetsDropped = 0;
+	uint64_t bytesSent = 0;
+	uint64_t bytesReceived = 0;
+};
+
+// a non-blocking UDP socket talking to one peer, with injected latency and loss
+class UdpChannel {
+public:
+	using clock = std::chrono::steady_clock;
+
+	UdpChannel(const NetworkConditions& _conditions, uint32_t seed);
+
+	// 0 for any free port
+	bool bind(unsigned short port);
+	unsigned short getLocalPort() const;
+
+	void setPeer(const sf::IpAddress& address, unsigned short port);
+	bool hasPeer() const;
+
+	// queue a packet for the peer, it goes out once its simulated delay is up
+	void send(const std::vector<uint8_t>& data);
+	// send anything whose delay is up, then read one packet if there is one;
+	// without a peer yet, whoever sends first becomes the peer
+	bool receive(std::vector<uint8_t>& data);
+	void flush();
+
+	const ChannelStats& getStats() const;
+
+private:
+	struct DelayedPacket {
+		bool queued = false;
+		clock::time_point due;
+		std::vector<uint8_t> data;
+	};
+
+	void sendNow(const std::vector<uint8_t>& data);
+
+	NetworkConditions conditions;
+	sf::UdpSocket socket;
+	sf::IpAddress peerAddress;
+	unsigned short peerPort = 0;
+
+	std::mt19937 random;
+	std::uniform_real_distribution<float> unit{0.0f, 1.0f};
+
+	// fixed set of reusable slots, packets can leave out of order when there's jitter
+	std::vector<DelayedPacket> delayed;
+	std::vector<uint8_t> receiveBuffer;
+
+	ChannelStats stats;
+};
+
+// message types, the first byte of every packet
+const uint8_t MESSAGE_INPUT = 'I';
+const uint8_t MESSAGE_SNAPSHOT = 'S';
+
+// no snapshot acknowledged yet
+const uint32_t NO_TICK = 0xffffffff;
+
+// one tick of player input, in the snapshot velocity units
+struct InputRecord {
+	uint32_t sequence;
+	int16_t x;
+	int16_t y;
+};
+
+// the client's most recent inputs, resent every time so a lost packet doesn't lose input
+void encodeInputBatch(
+	uint32_t sendTime,
+	uint32_t ackTick,
+	const std::vector<InputRecord>& inputs,
+	std::vector<uint8_t>& out
+);
+bool decodeInputBatch(
+	const std::vector<uint8_t>& data,
+	uint32_t& sendTime,
+	uint32_t& ackTick,
+	std::vector<InputRecord>& inputs
+);
+
+// a snapshot message is this header followed by an encoded WorldSnapshot,
+// repeatedTicks is how many ticks the server kept using lastInput while waiting for the next one,
+// and heldTime how many microseconds echoTime sat on the server, to take out of the round trip
+void encodeSnapshotHeader(
+	uint32_t lastInput,
+	uint32_t repeatedTicks,
+	uint32_t echoTime,
+	uint32_t heldTime,
+	std::vector<uint8_t>& out
+);
+bool decodeSnapshotHeader(
+	const std::vector<uint8_t>& data,
+	uint32_t& lastInput,
+	uint32_t& repeatedTicks,
+	uint32_t& echoTime,
+	uint32_t& heldTime,
+	size_t& payloadOffset
+);
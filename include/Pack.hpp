@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <streambuf>
+#include <string>
+#include <utility>
+#include <vector>
+
+// a game's data files bundled into one file, read through a memory mapping
+//
+// layout, all integers little-endian:
+//   header: "JPAK", version u32, entry count u32, table of contents offset u64
+//   file data, each file aligned to PACK_ALIGNMENT
+//   table of contents, sorted by name: name length u16, name, offset u64, size u64
+class PackFile {
+public:
+	static const uint32_t VERSION = 1;
+
+	struct Entry {
+		std::string name;
+		uint64_t offset;
+		uint64_t size;
+	};
+
+	PackFile() = default;
+	~PackFile();
+	PackFile(const PackFile&) = delete;
+	PackFile& operator=(const PackFile&) = delete;
+
+	// map the file and read its table of contents, false if it's missing or malformed
+	bool open(const std::string& _fileName);
+	void close();
+	bool isOpen() const;
+
+	// the file's bytes, straight from the mapping, false if it isn't in the pack
+	bool find(const std::string& name, const char*& data, size_t& size) const;
+	const std::vector<Entry>& getEntries() const;
+	// size of the whole mapping
+	size_t getSize() const;
+
+private:
+	bool readTableOfContents();
+
+	std::string fileName;
+	const char* mapping = nullptr;
+	size_t mappingSize = 0;
+	#ifdef _WIN32
+	void* fileHandle = nullptr;
+	void* mappingHandle = nullptr;
+	#endif
+	std::vector<Entry> entries;
+};
+
+const size_t PACK_ALIGNMENT = 16;
+
+// a file's name inside the pack, and its contents
+using PackInput = std::pair<std::string, std::vector<char>>;
+
+// write files into a new pack file, false if it can't be written or a name is used twice
+bool writePack(const std::string& fileName, const std::vector<PackInput>& files);
+
+// lets a stream read memory in place, like a file in a pack
+class MemoryStreamBuffer : public std::streambuf {
+public:
+	MemoryStreamBuffer(const char* data, size_t size);
+};
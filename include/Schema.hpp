@@ -0,0 +1,248 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <yaml-cpp/yaml.h>
+
+/*
+ * Declarative schemas for reading YAML into structs
+ *
+ * A struct gets a schema by specializing Schema<T> with a constexpr table of its fields:
+ *
+ *	template <>
+ *	struct Schema<Foo> {
+ *		static constexpr auto fields() {
+ *			return std::make_tuple(
+ *				field("size", &Foo::size, 0.0, 100.0),
+ *				field("name", &Foo::name)
+ *			);
+ *		}
+ *	};
+ *
+ * parseObject() then walks the map once, matching each key against the table, so nothing
+ * is looked up by name and scalars are converted in place without going through streams.
+ * Missing keys keep whatever the struct already holds, so set the defaults first.
+ * Unknown keys and bad values don't stop the parse, they're all collected in SchemaErrors.
+*/
+
+template <typename T>
+struct Schema;
+
+// where a value is in the document, only turned into text when something's wrong with it
+struct SchemaPath {
+	const SchemaPath* parent;
+	const char* key;
+
+	std::string toString() const;
+};
+
+class SchemaErrors {
+public:
+	void add(const SchemaPath& path, const std::string& problem);
+	void addUnknownKey(const SchemaPath& path, const std::string& key);
+	void addOutOfRange(const SchemaPath& path, double minimum, double maximum);
+
+	bool empty() const;
+	const std::vector<std::string>& get() const;
+
+private:
+	std::vector<std::string> problems;
+};
+
+// scalar conversions, false & an error for anything that isn't exactly the right type
+bool parseValue(const YAML::Node& node, bool& value, const SchemaPath& path, SchemaErrors& errors);
+bool parseValue(const YAML::Node& node, int& value, const SchemaPath& path, SchemaErrors& errors);
+bool parseValue(const YAML::Node& node, unsigned int& value, const SchemaPath& path, SchemaErrors& errors);
+bool parseValue(const YAML::Node& node, unsigned short& value, const SchemaPath& path, SchemaErrors& errors);
+bool parseValue(const YAML::Node& node, float& value, const SchemaPath& path, SchemaErrors& errors);
+bool parseValue(const YAML::Node& node, std::string& value, const SchemaPath& path, SchemaErrors& errors);
+bool parseValue(const YAML::Node& node, std::vector<unsigned int>& value, const SchemaPath& path, SchemaErrors& errors);
+// kept as is, for parts that are read later or have a shape of their own
+bool parseValue(const YAML::Node& node, YAML::Node& value, const SchemaPath& path, SchemaErrors& errors);
+
+// the same conversions on their own, for hot loops that report problems themselves
+bool scalarToFloat(const YAML::Node& node, float& value);
+bool scalarToUnsigned(const YAML::Node& node, unsigned long max, unsigned long& value);
+
+template <typename T>
+bool parseObject(const YAML::Node& node, T& object, const SchemaPath& path, SchemaErrors& errors);
+
+// anything with a schema of its own nests
+template <typename T, typename = decltype(Schema<T>::fields())>
+bool parseValue(const YAML::Node& node, T& value, const SchemaPath& path, SchemaErrors& errors) {
+	return parseObject(node, value, path, errors);
+}
+
+namespace schema_detail {
+
+constexpr size_t length(const char* text) {
+	size_t count = 0;
+	while (text[count] != '\0') {
+		count++;
+	}
+	return count;
+}
+
+// the key length is worked out at compile time, so most mismatches never look at the text
+struct Key {
+	const char* name;
+	size_t size;
+
+	bool matches(const std::string& text) const {
+		return text.size() == size && std::memcmp(text.data(), name, size) == 0;
+	}
+};
+
+// numbers go through a copy so a value out of range leaves the default alone
+template <typename T>
+bool parseChecked(
+	const YAML::Node& node, T& value, const double minimum, const double maximum,
+	const SchemaPath& path, SchemaErrors& errors, std::true_type
+) {
+	T parsed = value;
+	if (!parseValue(node, parsed, path, errors)) {
+		return false;
+	}
+	// written so anything unordered, like NaN, fails it too
+	if (!(static_cast<double>(parsed) >= minimum && static_cast<double>(parsed) <= maximum)) {
+		errors.addOutOfRange(path, minimum, maximum);
+		return false;
+	}
+	value = parsed;
+	return true;
+}
+
+// everything else is read in place, copying strings & nested structs would allocate
+template <typename T>
+bool parseChecked(
+	const YAML::Node& node, T& value, double, double, const SchemaPath& path, SchemaErrors& errors, std::false_type
+) {
+	return parseValue(node, value, path, errors);
+}
+
+template <typename Tuple, typename Function, size_t... Indexes>
+void forEach(const Tuple& tuple, Function&& function, std::index_sequence<Indexes...>) {
+	using expand = int[];
+	(void) expand{0, (function(std::get<Indexes>(tuple)), 0)...};
+}
+
+template <typename Tuple, typename Function>
+void forEach(const Tuple& tuple, Function&& function) {
+	forEach(tuple, function, std::make_index_sequence<std::tuple_size<Tuple>::value>());
+}
+
+}
+
+// a member read with the usual conversion for its type, numbers can be limited to a range
+template <typename Owner, typename T>
+struct Field {
+	schema_detail::Key key;
+	T Owner::* member;
+	double minimum;
+	double maximum;
+
+	bool parse(const YAML::Node& node, Owner& owner, const SchemaPath& path, SchemaErrors& errors) const {
+		return schema_detail::parseChecked(
+			node, owner.*member, minimum, maximum, path, errors, std::is_arithmetic<T>()
+		);
+	}
+};
+
+// a member of a member, for when the file is flatter than the struct
+template <typename Owner, typename Middle, typename T>
+struct NestedField {
+	schema_detail::Key key;
+	Middle Owner::* outer;
+	T Middle::* inner;
+	double minimum;
+	double maximum;
+
+	bool parse(const YAML::Node& node, Owner& owner, const SchemaPath& path, SchemaErrors& errors) const {
+		return schema_detail::parseChecked(
+			node, (owner.*outer).*inner, minimum, maximum, path, errors, std::is_arithmetic<T>()
+		);
+	}
+};
+
+// a member with a conversion of its own, like enums or maps keyed by names
+template <typename Owner, typename T>
+struct CustomField {
+	using Parser = bool (*)(const YAML::Node& node, T& value, const SchemaPath& path, SchemaErrors& errors);
+
+	schema_detail::Key key;
+	T Owner::* member;
+	Parser parser;
+
+	bool parse(const YAML::Node& node, Owner& owner, const SchemaPath& path, SchemaErrors& errors) const {
+		return parser(node, owner.*member, path, errors);
+	}
+};
+
+template <typename Owner, typename T>
+constexpr Field<Owner, T> field(
+	const char* key,
+	T Owner::* member,
+	const double minimum = std::numeric_limits<double>::lowest(),
+	const double maximum = std::numeric_limits<double>::max()
+) {
+	return {{key, schema_detail::length(key)}, member, minimum, maximum};
+}
+
+template <typename Owner, typename Middle, typename T>
+constexpr NestedField<Owner, Middle, T> field(
+	const char* key,
+	Middle Owner::* outer,
+	T Middle::* inner,
+	const double minimum = std::numeric_limits<double>::lowest(),
+	const double maximum = std::numeric_limits<double>::max()
+) {
+	return {{key, schema_detail::length(key)}, outer, inner, minimum, maximum};
+}
+
+template <typename Owner, typename T>
+constexpr CustomField<Owner, T> field(
+	const char* key, T Owner::* member, typename CustomField<Owner, T>::Parser parser
+) {
+	return {{key, schema_detail::length(key)}, member, parser};
+}
+
+template <typename T>
+bool parseObject(const YAML::Node& node, T& object, const SchemaPath& path, SchemaErrors& errors) {
+	if (!node || node.IsNull()) {
+		return true;
+	}
+	if (!node.IsMap()) {
+		errors.add(path, "should be a map");
+		return false;
+	}
+	const auto fields = Schema<T>::fields();
+	bool ok = true;
+	for (const auto& entry : node) {
+		if (!entry.first.IsScalar()) {
+			errors.add(path, "has a key that isn't a name");
+			ok = false;
+			continue;
+		}
+		const std::string& key = entry.first.Scalar();
+		bool found = false;
+		schema_detail::forEach(fields, [&](const auto& field) {
+			if (!found && field.key.matches(key)) {
+				found = true;
+				const SchemaPath fieldPath{&path, field.key.name};
+				ok = field.parse(entry.second, object, fieldPath, errors) && ok;
+			}
+		});
+		if (!found) {
+			errors.addUnknownKey(path, key);
+			ok = false;
+		}
+	}
+	return ok;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include <Network.hpp>
+#include <Snapshot.hpp>
+
+// the authoritative end of a local game, driven by the simulation thread
+class GameServer {
+public:
+	GameServer(unsigned short port, const NetworkConditions& conditions, uint32_t _snapshotInterval);
+
+	bool isListening() const;
+	unsigned short getPort() const;
+
+	// read everything the client sent, call once per tick before nextInput()
+	void receive();
+	// the player's input for this tick, repeats the last one when nothing new has arrived
+	InputRecord nextInput();
+	// send the world every snapshotInterval ticks, as a delta from what the client has
+	void sendSnapshot(const WorldSnapshot& snapshot);
+
+	const ChannelStats& getChannelStats() const;
+	// inputs that never arrived, despite the redundancy
+	uint64_t getInputsLost() const;
+
+private:
+	UdpChannel channel;
+	bool listening;
+	uint32_t snapshotInterval;
+	SnapshotCodec codec;
+
+	// recently sent snapshots, by tick, to encode deltas against
+	std::vector<WorldSnapshot> sent;
+	uint32_t ackTick = NO_TICK;
+	uint32_t echoTime = 0;
+	// when echoTime arrived, so the client can leave the wait for the next snapshot out of its round trip
+	std::chrono::steady_clock::time_point echoArrival;
+
+	// inputs waiting to be used, by sequence
+	std::vector<InputRecord> pending;
+	InputRecord lastInput{0, 0, 0};
+	// newest input used or skipped, the client replays everything after it
+	uint32_t processedSequence = 0;
+	// ticks lastInput has been used again since, the client has to replay them the same way
+	uint32_t repeatedTicks = 0;
+	uint32_t newestSequence = 0;
+	uint64_t inputsLost = 0;
+
+	std::vector<uint8_t> packet;
+	std::vector<uint8_t> payload;
+	std::vector<InputRecord> received;
+};
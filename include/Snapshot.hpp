@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// bump whenever the encoded layout changes
+const uint8_t SNAPSHOT_VERSION = 1;
+
+// most entities a snapshot may hold, so a corrupt or hostile packet can't ask for gigabytes
+const size_t SNAPSHOT_MAX_ENTITIES = 65536;
+
+// one entity's state, quantized to what's worth keeping
+struct EntityState {
+	uint32_t id;
+	// 1/16th of a pixel
+	int32_t x;
+	int32_t y;
+	// 1/65536th of a turn
+	uint16_t rotation;
+	// 1/128th of a unit
+	int16_t velocityX;
+	int16_t velocityY;
+	// 1/16th of a unit
+	uint16_t speed;
+};
+
+struct WorldSnapshot {
+	uint32_t tick = 0;
+	std::vector<EntityState> entities;
+};
+
+int32_t quantizePosition(float position);
+float dequantizePosition(int32_t position);
+uint16_t quantizeRotation(float degrees);
+float dequantizeRotation(uint16_t rotation);
+int16_t quantizeVelocity(float velocity);
+float dequantizeVelocity(int16_t velocity);
+uint16_t quantizeSpeed(float speed);
+float dequantizeSpeed(uint16_t speed);
+
+// turns snapshots into compact bytes and back, either whole or as the
+// XOR difference from a baseline snapshot both sides already have
+class SnapshotCodec {
+public:
+	// a key frame when there's no baseline, or the entity count changed
+	void encode(const WorldSnapshot& snapshot, const WorldSnapshot* baseline, std::vector<uint8_t>& out);
+	// false for corrupt data, more than SNAPSHOT_MAX_ENTITIES, or a delta that doesn't match the baseline
+	bool decode(const uint8_t* data, size_t size, const WorldSnapshot* baseline, WorldSnapshot& out);
+
+	// read just the tick numbers from an encoded snapshot, false if it's not one
+	static bool peekTicks(const uint8_t* data, size_t size, uint32_t& tick, uint32_t& baseTick);
+
+private:
+	// each byte of each field gets its own plane, so bytes that rarely change end up in long zero runs
+	static void pack(const std::vector<EntityState>& entities, std::vector<uint8_t>& planes);
+	static void unpack(const std::vector<uint8_t>& planes, std::vector<EntityState>& entities);
+
+	std::vector<uint8_t> planes;
+	std::vector<uint8_t> basePlanes;
+};
+
+// every recent tick, stored as deltas so rewinding one tick is a single decode
+class SnapshotHistory {
+public:
+	explicit SnapshotHistory(size_t _capacity);
+
+	void capture(const WorldSnapshot& snapshot);
+	// step back one tick, false when there's no more history
+	bool rewind(WorldSnapshot& snapshot);
+
+	size_t size() const;
+	size_t getCapacity() const;
+	size_t bytesUsed() const;
+
+private:
+	SnapshotCodec codec;
+	// entry n turns snapshot n + 1 back into snapshot n
+	std::vector<std::vector<uint8_t>> ring;
+	size_t capacity;
+	size_t head = 0;
+	size_t count = 0;
+	bool hasLatest = false;
+	WorldSnapshot latest;
+	WorldSnapshot previous;
+};
@@ -13,34 +13,75 @@
 
 #include <yaml-cpp/yaml.h>
 
+#include <Arena.hpp>
+#include <AssetSource.hpp>
+#include <Schema.hpp>
+#include <memory.hpp>
 #include <utilities.hpp>
 
 using namespace std::chrono_literals;
 
+// the top level of a sprite definition, the lists are only walked while building the geometry
+struct SpriteDefinition {
+	std::string type;
+	float size = 0.0f;
+	float rotation = 0.0f;
+	std::string behavior;
+	YAML::Node vertices;
+	YAML::Node colors;
+	YAML::Node indexes;
+};
+
+bool parseSpriteDefinition(
+	const YAML::Node& node, SpriteDefinition& definition, const SchemaPath& path, SchemaErrors& errors
+);
+
 class Sprite : public sf::Drawable, public sf::Transformable {
 public:
 	const float DEFAULT_SPRITE_SIZE = 50.0f;
 
 	Sprite() = delete;
 	explicit Sprite(const std::string& _fileName);
+	Sprite(const AssetSource& source, const std::string& name);
+	// from a definition that's already parsed, or made up on the spot
+	Sprite(const std::string& name, const YAML::Node& dataFile);
 	explicit Sprite(const sf::Texture& _texture);
 	explicit Sprite(const sf::Image& _image);
 	~Sprite() override;
 
 	void setVelocityDir(const float& x = 0, const float& y = 0);
+	const sf::Vector2f& getVelocityDir() const;
+	void setSpeed(float _speed);
+	float getSpeed() const;
 	void update(const std::chrono::nanoseconds& elapsed);
 
+	// draw with a transform captured earlier, the geometry never changes after loading
+	void drawWithTransform(sf::RenderTarget& target, const sf::Transform& transform) const;
+
+	// name of the AI behavior to run, empty if it has none
+	const std::string& getBehavior() const;
+
+	// false if the definition couldn't be read, the sprite is then empty
+	bool isLoaded() const;
+
+	// roughly how much memory the sprite takes, for budgeting caches of them
+	size_t getMemoryUsage() const;
+
 private:
 	std::string fileName;
+	std::string behavior;
 	float size;
 	sf::VertexArray vertices;
 	sf::Vector2f velocityDir;
 	float speed = 10;
+	bool loaded = false;
 	std::shared_ptr<sf::Texture> texture;
 
 	void draw(sf::RenderTarget& target, sf::RenderStates states) const override;
 
 	bool loadFromYAML(const std::string& _fileName);
+	bool loadFromAsset(const AssetSource& source, const std::string& name);
+	bool loadFromNode(const YAML::Node& dataFile);
 
 	void setTexture(const sf::Texture& _texture);
 	void setTexture(const sf::Image& _image);
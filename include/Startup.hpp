@@ -0,0 +1,65 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <threading.hpp>
+
+// engine initialization as a graph of stages, each running as soon as the
+// stages it depends on are done, on the main thread or on a worker
+class StartupGraph {
+public:
+	using clock = std::chrono::steady_clock;
+
+	enum class Where {
+		// window & GL context creation has to stay on the main thread
+		MainThread,
+		Worker
+	};
+
+	struct Stage {
+		std::string name;
+		Where where;
+		std::vector<size_t> dependencies;
+		std::function<void()> work;
+
+		bool started = false;
+		bool done = false;
+		bool failed = false;
+		clock::time_point startTime;
+		clock::time_point endTime;
+	};
+
+	explicit StartupGraph(clock::time_point _origin = clock::now());
+
+	// returns the stage's id, for use as a dependency of later stages
+	size_t addStage(const std::string& name, Where where, const std::vector<size_t>& dependencies, std::function<void()> work);
+
+	// run every stage, returns false if any of them threw or was skipped because of that
+	// workers are only started once a worker stage can run, so stages before that can decide their settings
+	bool run(const ThreadSettings& workerSettings, unsigned int maxWorkers);
+
+	// when each stage ran, relative to the origin, and the chain of stages that decided the total time
+	void logTimings() const;
+
+private:
+	// next stage that can run on this kind of thread, or NONE, call with the mutex locked
+	size_t takeReadyStage(Where where);
+	bool hasReadyStage(Where where) const;
+	bool allDone() const;
+	void runStage(size_t id, std::unique_lock<std::mutex>& lock);
+	void workerFunc(const ThreadSettings& settings);
+
+	static const size_t NONE = static_cast<size_t>(-1);
+
+	clock::time_point origin;
+	std::vector<Stage> stages;
+
+	std::mutex mutex;
+	// signalled whenever a stage finishes
+	std::condition_variable stageDone;
+};
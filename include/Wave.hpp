@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <yaml-cpp/yaml.h>
+
+// a group of identical enemies that arrive together
+struct WaveSpawn {
+	// sprite definition to copy, by name in the game's data
+	std::string sprite;
+	uint32_t count = 1;
+};
+
+// one stage of a level, the next wave arrives once this one's time is up
+struct Wave {
+	std::string name;
+	// seconds until the next wave
+	float duration = 30.0f;
+	std::vector<WaveSpawn> spawns;
+	// every sprite definition the spawns need, without repeats
+	std::vector<std::string> assets;
+};
+
+// read the list of waves, skipping any that make no sense
+bool nodeToWaves(const YAML::Node& node, std::vector<Wave>& waves);
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// subsystems that heap allocations are charged to
+enum class AllocationTag : uint8_t {
+	General,
+	Assets,
+	Entities,
+	Render,
+	Logging,
+	Count
+};
+
+const size_t ALLOCATION_TAG_COUNT = static_cast<size_t>(AllocationTag::Count);
+
+const char* allocationTagToString(AllocationTag tag);
+
+// false when built without JAGE_TRACK_ALLOCATIONS, all counters then stay at 0
+bool allocationTrackingEnabled();
+
+// process-wide totals for one tag
+struct AllocationCounters {
+	uint64_t allocations = 0;
+	uint64_t frees = 0;
+	int64_t liveBytes = 0;
+	int64_t peakBytes = 0;
+};
+
+AllocationCounters allocationCounters(AllocationTag tag);
+
+// allocations made by the calling thread since it started, all tags together
+uint64_t threadAllocationCount();
+uint64_t threadAllocationBytes();
+
+// the tag new allocations on the calling thread are charged to
+AllocationTag threadAllocationTag();
+void setThreadAllocationTag(AllocationTag tag);
+
+// charge allocations to a tag until the end of the scope
+class ScopedAllocationTag {
+public:
+	explicit ScopedAllocationTag(AllocationTag tag);
+	~ScopedAllocationTag();
+
+	ScopedAllocationTag(const ScopedAllocationTag&) = delete;
+	ScopedAllocationTag& operator=(const ScopedAllocationTag&) = delete;
+
+private:
+	AllocationTag previousTag;
+};
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <yaml-cpp/yaml.h>
+
+#include <Schema.hpp>
+
+// how a thread should be named, placed and scheduled
+struct ThreadSettings {
+	enum class Policy {
+		Default,
+		Nice,
+		Fifo
+	};
+
+	ThreadSettings() = default;
+	explicit ThreadSettings(const std::string& _name) : name(_name) {}
+
+	// shows up in top/perf, truncated to 15 characters on Linux
+	std::string name;
+	// cores the thread may run on, empty for any
+	std::vector<unsigned int> cores;
+	Policy policy = Policy::Default;
+	// nice level for Policy::Nice, real-time priority for Policy::Fifo
+	int priority = 0;
+};
+
+// default, nice or fifo
+bool parsePolicy(const YAML::Node& node, ThreadSettings::Policy& policy, const SchemaPath& path, SchemaErrors& errors);
+
+template <>
+struct Schema<ThreadSettings> {
+	static constexpr auto fields() {
+		return std::make_tuple(
+			field("name", &ThreadSettings::name),
+			field("cores", &ThreadSettings::cores),
+			field("policy", &ThreadSettings::policy, parsePolicy),
+			field("priority", &ThreadSettings::priority)
+		);
+	}
+};
+
+std::string threadSettingsToString(const ThreadSettings& settings);
+
+// apply the settings to the calling thread, returns what actually took effect
+std::string applyThreadSettings(const ThreadSettings& settings);
+
+// number of hardware threads and which of them this process may use
+std::string describeCpuTopology();
+
+// compact list like "0-3,6"
+std::string coresToString(const std::vector<unsigned int>& cores);
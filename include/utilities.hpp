@@ -13,6 +13,8 @@ std::string vertexToString(const sf::Vertex& vertex);
 
 std::string nodeTypeToString(const YAML::Node& node);
 
-sf::Vertex nodeToVertex(const YAML::Node& node, float size);
-sf::Color nodeToColor(const YAML::Node& node);
+// [x, y] scaled by half the size, false if it isn't a pair of numbers
+bool nodeToVertex(const YAML::Node& node, float size, sf::Vertex& vertex);
+// [r, g, b, a], missing primaries are 255 and bigger ones are clamped, false if it isn't a list of numbers
+bool nodeToColor(const YAML::Node& node, sf::Color& color);
 
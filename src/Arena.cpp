@@ -0,0 +1,87 @@
+#include <Arena.hpp>
+
+#include <algorithm>
+
+Arena::Arena(const size_t initialSize) {
+	addBlock(initialSize);
+}
+
+Arena::~Arena() {
+	for (auto& block : blocks) {
+		delete[] block.data;
+	}
+}
+
+void* Arena::allocate(const size_t size, const size_t alignment) {
+	while (true) {
+		Block& block = blocks[currentBlock];
+		const auto base = reinterpret_cast<uintptr_t>(block.data);
+		const size_t aligned = ((base + offset + alignment - 1) & ~(alignment - 1)) - base;
+		if (aligned + size <= block.size) {
+			offset = aligned + size;
+			return block.data + aligned;
+		}
+		// move on to a block kept from earlier, or grow
+		if (currentBlock + 1 == blocks.size()) {
+			addBlock(size + alignment);
+		}
+		currentBlock++;
+		offset = 0;
+	}
+}
+
+void Arena::deallocate(void* memory, const size_t size) {
+	char* end = static_cast<char*>(memory) + size;
+	if (end == blocks[currentBlock].data + offset) {
+		offset = static_cast<size_t>(static_cast<char*>(memory) - blocks[currentBlock].data);
+	}
+}
+
+void Arena::reset() {
+	if (blocks.size() > 1) {
+		// still warming up, replace the chain with one block that holds it all
+		const size_t total = getCapacity();
+		for (auto& block : blocks) {
+			delete[] block.data;
+		}
+		blocks.clear();
+		addBlock(total);
+	}
+	currentBlock = 0;
+	offset = 0;
+}
+
+Arena::Marker Arena::getMarker() const {
+	return {currentBlock, offset};
+}
+
+void Arena::rewind(const Marker& marker) {
+	currentBlock = marker.block;
+	offset = marker.offset;
+}
+
+size_t Arena::getUsed() const {
+	size_t used = offset;
+	for (size_t i = 0; i < currentBlock; i++) {
+		used += blocks[i].size;
+	}
+	return used;
+}
+
+size_t Arena::getCapacity() const {
+	size_t capacity = 0;
+	for (const auto& block : blocks) {
+		capacity += block.size;
+	}
+	return capacity;
+}
+
+void Arena::addBlock(const size_t minimumSize) {
+	const size_t size = blocks.empty() ? minimumSize : std::max(minimumSize, blocks.back().size * 2);
+	blocks.push_back({new char[size], size});
+}
+
+Arena& frameArena() {
+	thread_local Arena arena;
+	return arena;
+}
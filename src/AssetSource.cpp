@@ -0,0 +1,71 @@
+#include <AssetSource.hpp>
+
+#include <istream>
+
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include <easylogging++.h>
+
+namespace {
+
+// 0 if the file isn't there
+time_t modificationTime(const std::string& fileName) {
+	struct stat fileStat {};
+	if (stat(fileName.c_str(), &fileStat) != 0) {
+		return 0;
+	}
+	return fileStat.st_mtime;
+}
+
+}
+
+void AssetSource::open(const std::string& _dataDir, const std::string& packFile) {
+	dataDir = _dataDir;
+	packFileName = packFile.empty() ? dataDir + ".jpak" : packFile;
+	if (!pack.open(packFileName)) {
+		if (!packFile.empty()) {
+			LOG(WARNING) << "Can't open pack '" << packFileName << "', using the loose files";
+		}
+		return;
+	}
+	if (isPackStale(packFileName)) {
+		LOG(WARNING) << "'" << packFileName << "' is older than the files in " << dataDir
+			<< "/, using those instead, rebuild the pack to use it again";
+		pack.close();
+	}
+}
+
+bool AssetSource::isPackStale(const std::string& packFile) const {
+	const time_t packTime = modificationTime(packFile);
+	for (const auto& entry : pack.getEntries()) {
+		if (modificationTime(dataDir + "/" + entry.name) > packTime) {
+			return true;
+		}
+	}
+	return false;
+}
+
+bool AssetSource::isPacked() const {
+	return pack.isOpen();
+}
+
+std::string AssetSource::getLocation() const {
+	return isPacked() ? packFileName : dataDir + "/";
+}
+
+YAML::Node AssetSource::loadYAML(const std::string& name) const {
+	if (!isPacked()) {
+		return YAML::LoadFile(dataDir + "/" + name);
+	}
+	const char* data;
+	size_t size;
+	if (!pack.find(name, data, size)) {
+		// added since the pack was built, so only the loose copy has it
+		return YAML::LoadFile(dataDir + "/" + name);
+	}
+	// parse straight out of the mapping, no copy
+	MemoryStreamBuffer buffer(data, size);
+	std::istream stream(&buffer);
+	return YAML::Load(stream);
+}
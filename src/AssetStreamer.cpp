@@ -0,0 +1,140 @@
+#include <AssetStreamer.hpp>
+
+#include <algorithm>
+#include <chrono>
+
+#include <memory.hpp>
+
+using namespace std::chrono_literals;
+
+AssetStreamer::AssetStreamer(const AssetSource& _source, const size_t _memoryCap, const ThreadSettings& settings) :
+	source(_source),
+	memoryCap(_memoryCap),
+	thread(&AssetStreamer::threadFunc, this, settings) {
+}
+
+AssetStreamer::~AssetStreamer() {
+	std::unique_lock<std::mutex> lock(mutex);
+	stopping = true;
+	lock.unlock();
+	queueChanged.notify_all();
+	thread.join();
+}
+
+void AssetStreamer::prefetch(const std::string& name) {
+	std::unique_lock<std::mutex> lock(mutex);
+	auto assetIter = assets.find(name);
+	// failures aren't retried, they'd only fail again
+	if (assetIter != assets.end() && assetIter->second.state != State::Evicted) {
+		return;
+	}
+	assets[name] = Asset();
+	queue.push_back(name);
+	lock.unlock();
+	queueChanged.notify_one();
+}
+
+std::shared_ptr<const Sprite> AssetStreamer::find(const std::string& name) {
+	std::unique_lock<std::mutex> lock(mutex);
+	auto assetIter = assets.find(name);
+	if (assetIter == assets.end() || assetIter->second.state != State::Ready) {
+		return nullptr;
+	}
+	assetIter->second.lastUse = ++useClock;
+	return assetIter->second.sprite;
+}
+
+void AssetStreamer::pin(const std::vector<std::string>& names) {
+	std::unique_lock<std::mutex> lock(mutex);
+	for (auto& asset : assets) {
+		asset.second.pinned = false;
+	}
+	for (const auto& name : names) {
+		auto assetIter = assets.find(name);
+		if (assetIter != assets.end()) {
+			assetIter->second.pinned = true;
+		}
+	}
+	evict();
+}
+
+bool AssetStreamer::hasFailed(const std::string& name) const {
+	std::unique_lock<std::mutex> lock(mutex);
+	auto assetIter = assets.find(name);
+	return assetIter != assets.end() && assetIter->second.state == State::Failed;
+}
+
+AssetStreamer::Stats AssetStreamer::getStats() const {
+	std::unique_lock<std::mutex> lock(mutex);
+	return stats;
+}
+
+void AssetStreamer::threadFunc(const ThreadSettings settings) {
+	el::Helpers::setThreadName(settings.name);
+	LOG(INFO) << "Asset streamer thread: " << applyThreadSettings(settings);
+	setThreadAllocationTag(AllocationTag::Assets);
+
+	std::unique_lock<std::mutex> lock(mutex);
+	while (true) {
+		queueChanged.wait(lock, [this]() {
+			return stopping || !queue.empty();
+		});
+		if (stopping) {
+			break;
+		}
+		const std::string name = queue.front();
+		queue.pop_front();
+		auto assetIter = assets.find(name);
+		if (assetIter == assets.end() || assetIter->second.state != State::Queued) {
+			continue;
+		}
+		assetIter->second.state = State::Loading;
+		lock.unlock();
+
+		// parse without holding the lock, so the game never waits on a load
+		const auto loadStart = std::chrono::steady_clock::now();
+		auto sprite = std::make_shared<const Sprite>(source, name);
+		const auto loadTime = std::chrono::steady_clock::now() - loadStart;
+
+		lock.lock();
+		// the map never erases entries, so the iterator is still good
+		Asset& asset = assetIter->second;
+		stats.loadTime += static_cast<float>(loadTime / 1us) / 1000.0f;
+		if (!sprite->isLoaded()) {
+			LOG(ERROR) << "Can't stream '" << name << "'";
+			asset.state = State::Failed;
+			stats.failures++;
+			continue;
+		}
+		asset.state = State::Ready;
+		asset.sprite = sprite;
+		asset.bytes = sprite->getMemoryUsage();
+		asset.lastUse = ++useClock;
+		stats.loads++;
+		stats.bytes += asset.bytes;
+		stats.peakBytes = std::max(stats.peakBytes, stats.bytes);
+		evict();
+	}
+}
+
+void AssetStreamer::evict() {
+	while (stats.bytes > memoryCap) {
+		Asset* oldest = nullptr;
+		for (auto& asset : assets) {
+			if (asset.second.state == State::Ready && !asset.second.pinned
+				&& (oldest == nullptr || asset.second.lastUse < oldest->lastUse)) {
+				oldest = &asset.second;
+			}
+		}
+		if (oldest == nullptr) {
+			// everything left is pinned, so it has to stay over the cap
+			return;
+		}
+		// spawned enemies are copies, so dropping the original is always safe
+		stats.bytes -= oldest->bytes;
+		stats.evictions++;
+		oldest->sprite.reset();
+		oldest->bytes = 0;
+		oldest->state = State::Evicted;
+	}
+}
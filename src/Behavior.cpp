@@ -0,0 +1,258 @@
+#include <Behavior.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+#include <easylogging++.h>
+
+namespace {
+
+const float PI = 3.14159265f;
+// spreads per ship offsets evenly without any randomness
+const float GOLDEN_ANGLE = 2.39996323f;
+const float GOLDEN_RATIO_FRACTION = 0.61803399f;
+
+}
+
+bool BehaviorLibrary::loadFromYAML(const std::string& fileName) {
+	try {
+		LOG(INFO) << "Loading behaviors from '" << fileName << "'";
+		return loadFromNode(YAML::LoadFile(fileName));
+	} catch (YAML::Exception& e) {
+		LOG(ERROR) << "YAML Exception: " << e.what();
+		return false;
+	}
+}
+
+bool BehaviorLibrary::loadFromNode(const YAML::Node& node) {
+	if (!node || node.Type() != YAML::NodeType::Map) {
+		LOG(ERROR) << "Behaviors must be a map of names to behaviors";
+		return false;
+	}
+	bool ok = true;
+	for (auto&& behaviorIter = node.begin(); behaviorIter != node.end(); behaviorIter++) {
+		BehaviorProgram program;
+		program.name = behaviorIter->first.as<std::string>();
+		// a copy, operator-> hands out a temporary that dies with the statement
+		const YAML::Node behaviorNode = behaviorIter->second;
+		program.maxSpeed = behaviorNode["maxSpeed"].as<float>(program.maxSpeed);
+
+		YAML::Node stepsNode = behaviorNode["steps"];
+		if (stepsNode && stepsNode.Type() == YAML::NodeType::Sequence) {
+			for (auto&& stepIter = stepsNode.begin(); stepIter != stepsNode.end(); stepIter++) {
+				BehaviorInstruction instruction{};
+				if (compileStep(*stepIter, instruction)) {
+					program.code.push_back(instruction);
+				} else {
+					LOG(ERROR) << "Skipping invalid step in behavior '" << program.name << "': " << YAML::Dump(*stepIter);
+					ok = false;
+				}
+			}
+		}
+		LOG(INFO) << "Behavior '" << program.name << "': " << program.code.size() << " steps";
+		programs[program.name] = program;
+	}
+	return ok;
+}
+
+const BehaviorProgram* BehaviorLibrary::find(const std::string& name) const {
+	auto programIter = programs.find(name);
+	if (programIter == programs.end()) {
+		return nullptr;
+	}
+	return &programIter->second;
+}
+
+size_t BehaviorLibrary::size() const {
+	return programs.size();
+}
+
+bool BehaviorLibrary::compileStep(const YAML::Node& step, BehaviorInstruction& instruction) {
+	// each step is a single entry map, like "seek: {weight: 1}"
+	if (step.Type() != YAML::NodeType::Map || step.size() != 1) {
+		return false;
+	}
+	const std::string& op = step.begin()->first.as<std::string>();
+	const YAML::Node params = step.begin()->second;
+
+	if (op == "seek") {
+		instruction.op = BehaviorOp::Seek;
+		instruction.a = params["weight"].as<float>(1.0f);
+	} else if (op == "flee") {
+		instruction.op = BehaviorOp::Flee;
+		instruction.a = params["weight"].as<float>(1.0f);
+		instruction.b = params["radius"].as<float>(200.0f);
+	} else if (op == "wander") {
+		instruction.op = BehaviorOp::Wander;
+		instruction.a = params["weight"].as<float>(0.5f);
+		instruction.b = params["frequency"].as<float>(0.5f);
+	} else if (op == "orbit") {
+		instruction.op = BehaviorOp::Orbit;
+		instruction.a = params["weight"].as<float>(1.0f);
+		instruction.b = params["radius"].as<float>(250.0f);
+		instruction.c = params["clockwise"].as<bool>(true) ? 1.0f : -1.0f;
+	} else if (op == "formation") {
+		instruction.op = BehaviorOp::Formation;
+		instruction.a = params["weight"].as<float>(1.0f);
+		instruction.b = params["spacing"].as<float>(60.0f);
+		instruction.c = static_cast<float>(std::max(1u, params["columns"].as<uint32_t>(8)));
+		instruction.d = params["distance"].as<float>(300.0f);
+	} else if (op == "fire") {
+		instruction.op = BehaviorOp::Fire;
+		instruction.a = std::max(0.05f, params["interval"].as<float>(1.0f));
+		instruction.b = static_cast<float>(std::max(1u, params["count"].as<uint32_t>(1)));
+		instruction.c = params["spread"].as<float>(0.0f);
+		instruction.d = params["aimed"].as<bool>(true) ? 1.0f : 0.0f;
+	} else {
+		return false;
+	}
+	return true;
+}
+
+BehaviorBatch::BehaviorBatch(const BehaviorProgram& _program) :
+	program(_program) {
+}
+
+uint32_t BehaviorBatch::add(const float _x, const float _y) {
+	const auto index = static_cast<uint32_t>(x.size());
+	x.push_back(_x);
+	y.push_back(_y);
+	dirX.push_back(0.0f);
+	dirY.push_back(0.0f);
+	const float offset = static_cast<float>(index) * GOLDEN_RATIO_FRACTION;
+	phase.push_back(static_cast<float>(index) * GOLDEN_ANGLE);
+	fireTimer.push_back(offset - std::floor(offset));
+	return index;
+}
+
+void BehaviorBatch::remove(const uint32_t index) {
+	x[index] = x.back();
+	y[index] = y.back();
+	dirX[index] = dirX.back();
+	dirY[index] = dirY.back();
+	phase[index] = phase.back();
+	fireTimer[index] = fireTimer.back();
+	x.pop_back();
+	y.pop_back();
+	dirX.pop_back();
+	dirY.pop_back();
+	phase.pop_back();
+	fireTimer.pop_back();
+}
+
+size_t BehaviorBatch::size() const {
+	return x.size();
+}
+
+const BehaviorProgram& BehaviorBatch::getProgram() const {
+	return program;
+}
+
+void BehaviorBatch::evaluate(const float elapsedSeconds, const float targetX, const float targetY) {
+	const size_t count = x.size();
+	time += elapsedSeconds;
+	fired.clear();
+
+	// steering accumulates into the output arrays, scaled to speed at the end
+	std::fill(dirX.begin(), dirX.end(), 0.0f);
+	std::fill(dirY.begin(), dirY.end(), 0.0f);
+
+	for (const auto& instruction : program.code) {
+		switch (instruction.op) {
+		case BehaviorOp::Seek:
+			for (size_t i = 0; i < count; i++) {
+				const float dx = targetX - x[i];
+				const float dy = targetY - y[i];
+				const float length = std::sqrt(dx * dx + dy * dy);
+				const float scale = length > 1.0f ? instruction.a / length : 0.0f;
+				dirX[i] += dx * scale;
+				dirY[i] += dy * scale;
+			}
+			break;
+		case BehaviorOp::Flee:
+			for (size_t i = 0; i < count; i++) {
+				const float dx = x[i] - targetX;
+				const float dy = y[i] - targetY;
+				const float length = std::sqrt(dx * dx + dy * dy);
+				// strongest up close, nothing outside the radius
+				const float strength = std::max(0.0f, 1.0f - length / instruction.b);
+				const float scale = length > 1.0f ? instruction.a * strength / length : 0.0f;
+				dirX[i] += dx * scale;
+				dirY[i] += dy * scale;
+			}
+			break;
+		case BehaviorOp::Wander: {
+			const float angularSpeed = instruction.b * 2.0f * PI;
+			for (size_t i = 0; i < count; i++) {
+				const float angle = phase[i] + time * angularSpeed;
+				dirX[i] += std::cos(angle) * instruction.a;
+				dirY[i] += std::sin(angle) * instruction.a;
+			}
+			break;
+		}
+		case BehaviorOp::Orbit:
+			for (size_t i = 0; i < count; i++) {
+				const float dx = x[i] - targetX;
+				const float dy = y[i] - targetY;
+				const float length = std::sqrt(dx * dx + dy * dy);
+				if (length < 1.0f) {
+					continue;
+				}
+				// circle around the target, pulled in or pushed out towards the radius
+				const float radial = (instruction.b - length) / instruction.b;
+				dirX[i] += (-dy * instruction.c + dx * radial) * instruction.a / length;
+				dirY[i] += (dx * instruction.c + dy * radial) * instruction.a / length;
+			}
+			break;
+		case BehaviorOp::Formation: {
+			const auto columns = static_cast<size_t>(instruction.c);
+			const float centerColumn = (instruction.c - 1.0f) / 2.0f;
+			for (size_t i = 0; i < count; i++) {
+				const float column = static_cast<float>(i % columns);
+				const float row = static_cast<float>(i / columns);
+				// rows stack up away from the target, which is below the enemies
+				const float slotX = targetX + (column - centerColumn) * instruction.b;
+				const float slotY = targetY - instruction.d - row * instruction.b;
+				const float dx = slotX - x[i];
+				const float dy = slotY - y[i];
+				const float length = std::sqrt(dx * dx + dy * dy);
+				// slow down when arriving in the slot
+				const float scale = instruction.a / std::max(length, instruction.b);
+				dirX[i] += dx * scale;
+				dirY[i] += dy * scale;
+			}
+			break;
+		}
+		case BehaviorOp::Fire: {
+			const auto shots = static_cast<uint32_t>(instruction.b);
+			const float spread = instruction.c * PI / 180.0f;
+			for (size_t i = 0; i < count; i++) {
+				fireTimer[i] += elapsedSeconds;
+				if (fireTimer[i] < instruction.a) {
+					continue;
+				}
+				fireTimer[i] -= instruction.a;
+				// straight down unless aimed
+				float baseAngle = PI / 2.0f;
+				if (instruction.d != 0.0f) {
+					baseAngle = std::atan2(targetY - y[i], targetX - x[i]);
+				}
+				for (uint32_t shot = 0; shot < shots; shot++) {
+					const float fraction = shots > 1 ? static_cast<float>(shot) / static_cast<float>(shots - 1) - 0.5f : 0.0f;
+					const float angle = baseAngle + fraction * spread;
+					fired.push_back({static_cast<uint32_t>(i), x[i], y[i], std::cos(angle), std::sin(angle)});
+				}
+			}
+			break;
+		}
+		}
+	}
+
+	// clamp the combined steering to the behavior's top speed
+	for (size_t i = 0; i < count; i++) {
+		const float length = std::sqrt(dirX[i] * dirX[i] + dirY[i] * dirY[i]);
+		const float scale = program.maxSpeed / std::max(length, 1.0f);
+		dirX[i] *= scale;
+		dirY[i] *= scale;
+	}
+}
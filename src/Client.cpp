@@ -0,0 +1,254 @@
+#include <Client.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+const size_t INPUT_HISTORY = 128;
+const size_t SNAPSHOT_HISTORY = 64;
+// further off than this and the render clock jumps instead of easing
+const float MAX_CLOCK_DRIFT = 30.0f;
+const float CLOCK_EASING = 0.05f;
+
+bool isNewer(const uint32_t a, const uint32_t b) {
+	return static_cast<int32_t>(a - b) > 0;
+}
+
+float lerp(const float a, const float b, const float t) {
+	return a + (b - a) * t;
+}
+
+}
+
+GameClient::GameClient(
+	const unsigned short serverPort,
+	const NetworkConditions& conditions,
+	const std::vector<std::shared_ptr<Sprite>>& serverSprites,
+	const uint32_t _playerId,
+	const std::chrono::nanoseconds _tickDuration,
+	const uint32_t _interpolationTicks,
+	const uint32_t _inputRedundancy
+) :
+	channel(conditions, 2),
+	startTime(std::chrono::steady_clock::now()),
+	playerId(_playerId),
+	tickDuration(_tickDuration),
+	interpolationTicks(_interpolationTicks),
+	inputRedundancy(std::max(1u, _inputRedundancy)),
+	inputHistory(INPUT_HISTORY, PredictedInput{InputRecord{0, 0, 0}, sf::Vector2f()}),
+	snapshots(SNAPSHOT_HISTORY) {
+	// the same ships, but only ever moved by this client
+	for (const auto& sprite : serverSprites) {
+		sprites.push_back(std::make_shared<Sprite>(*sprite));
+	}
+	connected = channel.bind(0);
+	if (connected) {
+		channel.setPeer(sf::IpAddress::LocalHost, serverPort);
+		LOG(INFO) << "Client on port " << channel.getLocalPort() << " talking to server on port " << serverPort;
+	} else {
+		LOG(ERROR) << "Client can't bind a port";
+	}
+}
+
+bool GameClient::isConnected() const {
+	return connected;
+}
+
+void GameClient::tick(const float x, const float y) {
+	std::unique_lock<std::mutex> spritesLock(spritesMutex);
+
+	receiveSnapshots();
+
+	// predict the player's move right away instead of waiting a round trip for the server
+	const InputRecord input{nextSequence++, quantizeVelocity(x), quantizeVelocity(y)};
+	applyInput(input);
+	inputHistory[input.sequence % INPUT_HISTORY] = {input, sprites[playerId]->getPosition()};
+
+	renderTick += 1.0f;
+	interpolate();
+
+	spritesLock.unlock();
+
+	// resend the last few inputs too, so one lost packet doesn't lose any input
+	outgoing.clear();
+	const uint32_t oldest = input.sequence > inputRedundancy ? input.sequence - inputRedundancy + 1 : 1;
+	for (uint32_t sequence = oldest; sequence <= input.sequence; sequence++) {
+		const PredictedInput& predicted = inputHistory[sequence % INPUT_HISTORY];
+		if (predicted.input.sequence == sequence) {
+			outgoing.push_back(predicted.input);
+		}
+	}
+	encodeInputBatch(now(), newestTick, outgoing, packet);
+	channel.send(packet);
+}
+
+const std::vector<std::shared_ptr<Sprite>>& GameClient::getSprites() const {
+	return sprites;
+}
+
+std::mutex& GameClient::getSpritesMutex() {
+	return spritesMutex;
+}
+
+const GameClient::Stats& GameClient::getStats() const {
+	return stats;
+}
+
+const ChannelStats& GameClient::getChannelStats() const {
+	return channel.getStats();
+}
+
+void GameClient::receiveSnapshots() {
+	while (channel.receive(packet)) {
+		uint32_t processedSequence;
+		uint32_t repeatedTicks;
+		uint32_t echoTime;
+		uint32_t heldTime;
+		size_t payloadOffset;
+		uint32_t tick;
+		uint32_t baseTick;
+		if (!decodeSnapshotHeader(packet, processedSequence, repeatedTicks, echoTime, heldTime, payloadOffset)
+			|| !SnapshotCodec::peekTicks(&packet[payloadOffset], packet.size() - payloadOffset, tick, baseTick)) {
+			stats.snapshotsRejected++;
+			continue;
+		}
+		// late arrivals are no use, a newer snapshot has already been applied
+		if (newestTick != NO_TICK && !isNewer(tick, newestTick)) {
+			continue;
+		}
+		const WorldSnapshot& baseline = snapshots[baseTick % SNAPSHOT_HISTORY];
+		const bool haveBaseline = newestTick != NO_TICK && baseline.tick == baseTick;
+		if (!codec.decode(&packet[payloadOffset], packet.size() - payloadOffset, haveBaseline ? &baseline : nullptr, decoded)) {
+			stats.snapshotsRejected++;
+			continue;
+		}
+		WorldSnapshot& snapshot = snapshots[tick % SNAPSHOT_HISTORY];
+		std::swap(snapshot, decoded);
+		newestTick = tick;
+		stats.snapshotsReceived++;
+
+		// just the time on the wire, not the time the server sat on the input waiting to send a snapshot
+		const uint32_t elapsed = now() - echoTime;
+		const float roundTrip = static_cast<float>(elapsed - std::min(elapsed, heldTime)) / 1000.0f;
+		stats.lastRoundTrip = roundTrip;
+		stats.totalRoundTrip += roundTrip;
+		stats.maxRoundTrip = std::max(stats.maxRoundTrip, roundTrip);
+
+		// keep showing the world a fixed distance behind the newest snapshot
+		const float targetTick = static_cast<float>(tick) - static_cast<float>(interpolationTicks);
+		if (stats.snapshotsReceived == 1 || std::abs(targetTick - renderTick) > MAX_CLOCK_DRIFT) {
+			renderTick = targetTick;
+		} else {
+			renderTick += (targetTick - renderTick) * CLOCK_EASING;
+		}
+
+		reconcile(processedSequence, repeatedTicks, snapshot);
+	}
+}
+
+void GameClient::reconcile(const uint32_t processedSequence, const uint32_t repeatedTicks, const WorldSnapshot& snapshot) {
+	if (playerId >= snapshot.entities.size()) {
+		return;
+	}
+	const EntityState& state = snapshot.entities[playerId];
+	const sf::Vector2f serverPosition(dequantizePosition(state.x), dequantizePosition(state.y));
+
+	Sprite& player = *sprites[playerId];
+
+	// how far off was the prediction for the last input the server used, after carrying on
+	// with it for as many ticks as the server did while the next one hadn't arrived
+	const PredictedInput& predicted = inputHistory[processedSequence % INPUT_HISTORY];
+	if (processedSequence != 0 && predicted.input.sequence == processedSequence && repeatedTicks < INPUT_HISTORY) {
+		player.setPosition(predicted.position);
+		for (uint32_t i = 0; i < repeatedTicks; i++) {
+			applyInput(predicted.input);
+		}
+		const sf::Vector2f error = player.getPosition() - serverPosition;
+		const float distance = std::sqrt(error.x * error.x + error.y * error.y);
+		stats.predictionChecks++;
+		stats.totalPredictionError += distance;
+		stats.maxPredictionError = std::max(stats.maxPredictionError, distance);
+	}
+
+	player.setPosition(serverPosition);
+	player.setRotation(dequantizeRotation(state.rotation));
+	player.setSpeed(dequantizeSpeed(state.speed));
+	// anything older than the history has been forgotten already
+	uint32_t firstReplay = processedSequence + 1;
+	if (isNewer(nextSequence - static_cast<uint32_t>(INPUT_HISTORY), firstReplay)) {
+		firstReplay = nextSequence - static_cast<uint32_t>(INPUT_HISTORY);
+	}
+	for (uint32_t sequence = firstReplay; isNewer(nextSequence, sequence); sequence++) {
+		PredictedInput& replay = inputHistory[sequence % INPUT_HISTORY];
+		if (replay.input.sequence != sequence) {
+			continue;
+		}
+		applyInput(replay.input);
+		replay.position = player.getPosition();
+	}
+}
+
+void GameClient::applyInput(const InputRecord& input) {
+	Sprite& player = *sprites[playerId];
+	player.setVelocityDir(dequantizeVelocity(input.x), dequantizeVelocity(input.y));
+	player.update(tickDuration);
+}
+
+void GameClient::interpolate() {
+	if (newestTick == NO_TICK) {
+		return;
+	}
+	// find the snapshots either side of the render tick
+	const WorldSnapshot* before = nullptr;
+	const WorldSnapshot* after = nullptr;
+	for (const auto& snapshot : snapshots) {
+		if (snapshot.entities.empty() || isNewer(snapshot.tick, newestTick)) {
+			continue;
+		}
+		const auto tick = static_cast<float>(snapshot.tick);
+		if (tick <= renderTick && (before == nullptr || snapshot.tick > before->tick)) {
+			before = &snapshot;
+		}
+		if (tick > renderTick && (after == nullptr || snapshot.tick < after->tick)) {
+			after = &snapshot;
+		}
+	}
+	if (before == nullptr) {
+		before = after;
+	}
+	if (after == nullptr || after->entities.size() != before->entities.size()) {
+		after = before;
+	}
+	if (before == nullptr) {
+		return;
+	}
+	float t = 0.0f;
+	if (after->tick != before->tick) {
+		t = (renderTick - static_cast<float>(before->tick)) / static_cast<float>(after->tick - before->tick);
+		t = std::min(1.0f, std::max(0.0f, t));
+	}
+
+	const size_t count = std::min(before->entities.size(), sprites.size());
+	for (size_t i = 0; i < count; i++) {
+		if (i == playerId) {
+			continue;
+		}
+		const EntityState& a = before->entities[i];
+		const EntityState& b = after->entities[i];
+		// rotation takes the short way around
+		const auto rotationDelta = static_cast<int16_t>(static_cast<uint16_t>(b.rotation - a.rotation));
+		sprites[i]->setPosition(
+			lerp(dequantizePosition(a.x), dequantizePosition(b.x), t),
+			lerp(dequantizePosition(a.y), dequantizePosition(b.y), t)
+		);
+		sprites[i]->setRotation(dequantizeRotation(a.rotation) + static_cast<float>(rotationDelta) * t * 360.0f / 65536.0f);
+	}
+}
+
+uint32_t GameClient::now() const {
+	// microseconds, wrapping every hour or so is fine for round trips
+	return static_cast<uint32_t>(
+		std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime).count()
+	);
+}
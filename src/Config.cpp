@@ -0,0 +1,115 @@
+#include <Config.hpp>
+
+#include <limits>
+
+namespace {
+
+// budgets are keyed by tag name, like "assets: 16"
+bool parseMemoryBudgets(
+	const YAML::Node& node, float (&budgets)[ALLOCATION_TAG_COUNT], const SchemaPath& path, SchemaErrors& errors
+) {
+	if (!node.IsMap()) {
+		errors.add(path, "should be a map");
+		return false;
+	}
+	bool ok = true;
+	for (const auto& entry : node) {
+		if (!entry.first.IsScalar()) {
+			errors.add(path, "has a key that isn't a name");
+			ok = false;
+			continue;
+		}
+		const std::string& key = entry.first.Scalar();
+		size_t tag = 0;
+		while (tag < ALLOCATION_TAG_COUNT && key != allocationTagToString(static_cast<AllocationTag>(tag))) {
+			tag++;
+		}
+		if (tag == ALLOCATION_TAG_COUNT) {
+			errors.addUnknownKey(path, key);
+			ok = false;
+			continue;
+		}
+		const SchemaPath budgetPath{&path, allocationTagToString(static_cast<AllocationTag>(tag))};
+		float budget = budgets[tag];
+		if (!parseValue(entry.second, budget, budgetPath, errors)) {
+			ok = false;
+		} else if (budget < 0.0f) {
+			errors.addOutOfRange(budgetPath, 0.0, std::numeric_limits<double>::max());
+			ok = false;
+		} else {
+			budgets[tag] = budget;
+		}
+	}
+	return ok;
+}
+
+}
+
+template <>
+struct Schema<EngineConfig::Threads> {
+	static constexpr auto fields() {
+		return std::make_tuple(
+			field("main", &EngineConfig::Threads::main),
+			field("simulation", &EngineConfig::Threads::simulation),
+			field("render", &EngineConfig::Threads::render),
+			field("worker", &EngineConfig::Threads::worker),
+			field("client", &EngineConfig::Threads::client),
+			field("streamer", &EngineConfig::Threads::streamer)
+		);
+	}
+};
+
+template <>
+struct Schema<EngineConfig::Streaming> {
+	static constexpr auto fields() {
+		return std::make_tuple(
+			field("memoryCap", &EngineConfig::Streaming::memoryCap, 0.0),
+			field("prefetchWaves", &EngineConfig::Streaming::prefetchWaves)
+		);
+	}
+};
+
+// the conditions sit right in the network section of the file
+template <>
+struct Schema<EngineConfig::Network> {
+	static constexpr auto fields() {
+		return std::make_tuple(
+			field("enabled", &EngineConfig::Network::enabled),
+			field("port", &EngineConfig::Network::port),
+			field("latency", &EngineConfig::Network::conditions, &NetworkConditions::latency, 0.0),
+			field("jitter", &EngineConfig::Network::conditions, &NetworkConditions::jitter, 0.0),
+			field("loss", &EngineConfig::Network::conditions, &NetworkConditions::loss, 0.0, 1.0),
+			field("snapshotInterval", &EngineConfig::Network::snapshotInterval, 1.0),
+			field("inputRedundancy", &EngineConfig::Network::inputRedundancy, 1.0),
+			field("interpolationDelay", &EngineConfig::Network::interpolationDelay, 0.0)
+		);
+	}
+};
+
+template <>
+struct Schema<EngineConfig> {
+	static constexpr auto fields() {
+		return std::make_tuple(
+			field("name", &EngineConfig::name),
+			field("width", &EngineConfig::width, 1.0),
+			field("height", &EngineConfig::height, 1.0),
+			field("fullscreen", &EngineConfig::fullscreen),
+			field("useDesktopSize", &EngineConfig::useDesktopSize),
+			field("vsync", &EngineConfig::vsync),
+			field("targetFps", &EngineConfig::targetFps),
+			field("justInTime", &EngineConfig::justInTime),
+			field("jitMargin", &EngineConfig::jitMargin, 0.0),
+			field("threads", &EngineConfig::threads),
+			field("memoryBudgets", &EngineConfig::memoryBudgets, parseMemoryBudgets),
+			field("rewindSeconds", &EngineConfig::rewindSeconds, 0.0),
+			field("streaming", &EngineConfig::streaming),
+			field("network", &EngineConfig::network),
+			field("deadzone", &EngineConfig::deadZone, 0.0, 100.0),
+			field("keySpeed", &EngineConfig::keySpeed, 0.0)
+		);
+	}
+};
+
+bool parseEngineConfig(const YAML::Node& node, EngineConfig& config, const SchemaPath& path, SchemaErrors& errors) {
+	return parseObject(node, config, path, errors);
+}
@@ -7,13 +7,17 @@ INITIALIZE_EASYLOGGINGPP
 #endif
 
 Engine::Engine(const int _argc, const char** _argv) :
-	argc(_argc), argv(_argv) {
+	argc(_argc), argv(_argv), startupTime(std::chrono::steady_clock::now()) {
 	// check if a game directory is specified on the command line
 	if (argc > 1 && argv[1] != nullptr) {
 		game = std::string(argv[1]);
 	} else {
 		game = "game";
 	}
+	// and optionally a pack to use instead of <game>.jpak, like the one the build makes
+	if (argc > 2 && argv[2] != nullptr) {
+		packFile = std::string(argv[2]);
+	}
 
 	// set some global logging flags
 	el::Loggers::addFlag(el::LoggingFlag::NewLineForContainer);
@@ -35,8 +39,6 @@ Engine::Engine(const int _argc, const char** _argv) :
 
 	LOG(INFO) << "Logging system initialized.";
 
-	dumpSystemInfo();
-
 	LOG(INFO) << "Initializing Engine with game data in '" << game << "'";
 
 	data_dir = game;
@@ -44,33 +46,109 @@ Engine::Engine(const int _argc, const char** _argv) :
 	// TODO: verify data_dir is accessible, abort if not
 	// TODO: chdir into data_dir for easier relative paths everywhere else
 
-	readConfig();
-
-	createWindow(config.fullscreen);
-
-	std::unique_lock<std::mutex> spritesLock(spritesMutex);
-	LOG(INFO) << "Creating entities from YAML";
-	player = std::make_shared<Sprite>(data_dir + "/player.yaml");
-	player->setPosition(
-		static_cast<float>(renderWidth * 1 / 2),
-		static_cast<float>(renderHeight * 3 / 4)
-	);
-	sprites.push_back(player);
-	LOG(INFO) << "Created player";
-	enemy = std::make_shared<Sprite>(data_dir + "/enemy.yaml");
-	enemy->setPosition(
-		static_cast<float>(renderWidth * 1 / 2),
-		static_cast<float>(renderHeight * 1 / 4)
-	);
-	sprites.push_back(enemy);
-	LOG(INFO) << "Created enemy";
-	spritesLock.unlock();
-
-	isReady = true;
-	LOG(INFO) << "Initialization Complete";
+	// everything after the config runs as soon as what it needs is ready,
+	// so the assets load while the window & GL context are being created
+	StartupGraph startup(startupTime);
+	using Where = StartupGraph::Where;
+	const size_t packStage = startup.addStage("pack", Where::MainThread, {}, [this]() {
+		assets.open(data_dir, packFile);
+		LOG(INFO) << "Game data from " << assets.getLocation();
+	});
+	const size_t configStage = startup.addStage("config", Where::MainThread, {packStage}, [this]() {
+		readConfig();
+	});
+	startup.addStage("window", Where::MainThread, {configStage}, [this]() {
+		createWindow(config.fullscreen);
+	});
+	startup.addStage("sysinfo", Where::Worker, {configStage}, [this]() {
+		dumpSystemInfo();
+	});
+	startup.addStage("history", Where::Worker, {configStage}, [this]() {
+		history = std::make_unique<SnapshotHistory>(static_cast<size_t>(config.rewindSeconds * static_cast<float>(simulationHz)));
+	});
+	const size_t behaviorsStage = startup.addStage("behaviors", Where::Worker, {configStage}, [this]() {
+		try {
+			behaviors.loadFromNode(assets.loadYAML("behaviors.yaml"));
+		} catch (YAML::Exception& e) {
+			LOG(ERROR) << "YAML Exception: " << e.what();
+		}
+	});
+	startup.addStage("waves", Where::Worker, {configStage}, [this]() {
+		try {
+			nodeToWaves(assets.loadYAML("waves.yaml"), waves);
+		} catch (YAML::Exception& e) {
+			LOG(ERROR) << "YAML Exception: " << e.what();
+		}
+		LOG(INFO) << "Loaded " << waves.size() << " waves";
+		streamer = std::make_unique<AssetStreamer>(
+			assets,
+			static_cast<size_t>(config.streaming.memoryCap * 1024 * 1024),
+			config.threads.streamer
+		);
+		// the first waves load while the rest of startup finishes
+		streamWaves(0);
+	});
+	const size_t playerStage = startup.addStage("player", Where::Worker, {configStage}, [this]() {
+		ScopedAllocationTag entitiesTag(AllocationTag::Entities);
+		player = std::make_shared<Sprite>(assets, "player.yaml");
+		player->setPosition(
+			static_cast<float>(renderWidth * 1 / 2),
+			static_cast<float>(renderHeight * 3 / 4)
+		);
+		LOG(INFO) << "Created player";
+	});
+	const size_t enemyStage = startup.addStage("enemy", Where::Worker, {configStage}, [this]() {
+		ScopedAllocationTag entitiesTag(AllocationTag::Entities);
+		enemy = std::make_shared<Sprite>(assets, "enemy.yaml");
+		enemy->setPosition(
+			static_cast<float>(renderWidth * 1 / 2),
+			static_cast<float>(renderHeight * 1 / 4)
+		);
+		LOG(INFO) << "Created enemy";
+	});
+	startup.addStage("world", Where::Worker, {behaviorsStage, playerStage, enemyStage}, [this]() {
+		std::unique_lock<std::mutex> spritesLock(spritesMutex);
+		ScopedAllocationTag entitiesTag(AllocationTag::Entities);
+		// the player is always first, the client relies on the order staying put
+		addToWorld(player);
+		addToWorld(enemy);
+		addEnemy(enemy);
+
+		if (config.network.enabled) {
+			LOG(INFO) << "Starting local server";
+			server = std::make_unique<GameServer>(config.network.port, config.network.conditions, config.network.snapshotInterval);
+			if (server->isListening()) {
+				client = std::make_unique<GameClient>(
+					server->getPort(),
+					config.network.conditions,
+					sprites,
+					static_cast<uint32_t>(std::find(sprites.begin(), sprites.end(), player) - sprites.begin()),
+					std::chrono::nanoseconds(1s) / simulationHz,
+					static_cast<uint32_t>(config.network.interpolationDelay * static_cast<float>(simulationHz) / 1000.0f),
+					config.network.inputRedundancy
+				);
+			}
+			if (!client || !client->isConnected()) {
+				LOG(ERROR) << "Can't set up networking, playing locally instead";
+				client.reset();
+				server.reset();
+			}
+		}
+	});
+	// one worker per core, leaving the main thread its own
+	isReady = startup.run(config.threads.worker, std::max(2u, std::thread::hardware_concurrency()) - 1);
+	startup.logTimings();
+
+	if (isReady) {
+		LOG(INFO) << "Initialization Complete, took "
+			<< static_cast<float>((std::chrono::steady_clock::now() - startupTime) / 1us) / 1000.0f << "ms";
+	} else {
+		LOG(ERROR) << "Initialization failed";
+	}
 }
 
 Engine::~Engine() {
+	dumpMemoryStats();
 	LOG(INFO) << "Logging system shutting down";
 	el::Loggers::flushAll();
 }
@@ -88,8 +166,21 @@ bool Engine::run() {
 	LOG(INFO) << "Creating render thread";
 	renderThread = std::make_unique<std::thread>(&Engine::renderThreadFunc, this);
 
+	if (client) {
+		LOG(INFO) << "Creating client thread";
+		clientThread = std::make_unique<std::thread>(&Engine::clientThreadFunc, this);
+	}
+
+	// only after the other threads exist, so they don't inherit the main thread's affinity
+	el::Helpers::setThreadName(config.threads.main.name);
+	LOG(INFO) << "Main thread: " << applyThreadSettings(config.threads.main);
+
 	LOG(INFO) << "Starting event loop";
+	const auto startTime = std::chrono::steady_clock::now();
+	std::unique_lock<std::mutex> runningLock(runningMutex);
 	running = true;
+	runningLock.unlock();
+	runningChanged.notify_all();
 	while (running) {
 		processEvents();
 		std::this_thread::yield();
@@ -102,6 +193,12 @@ bool Engine::run() {
 	LOG(INFO) << "Stopping render thread";
 	renderThread->join();
 
+	if (clientThread) {
+		LOG(INFO) << "Stopping client thread";
+		clientThread->join();
+		dumpNetworkStats(std::chrono::duration<float>(std::chrono::steady_clock::now() - startTime).count());
+	}
+
 	if (window.isOpen()) {
 		LOG(INFO) << "Closing window";
 		window.close();
@@ -111,18 +208,28 @@ bool Engine::run() {
 	return true;
 }
 
+void Engine::waitUntilRunning() {
+	std::unique_lock<std::mutex> runningLock(runningMutex);
+	runningChanged.wait(runningLock, [this]() {
+		return running.load();
+	});
+}
+
 // runs in its own thread
 void Engine::simulationThreadFunc() {
 	LOG(INFO) << "Initializing simulation thread";
+	el::Helpers::setThreadName(config.threads.simulation.name);
+	LOG(INFO) << "Simulation thread: " << applyThreadSettings(config.threads.simulation);
+	setThreadAllocationTag(AllocationTag::Entities);
 
-	uint32_t simulationWaitTime;
 	std::chrono::time_point<std::chrono::high_resolution_clock, std::chrono::nanoseconds> startSimulationTime;
 	std::chrono::time_point<std::chrono::high_resolution_clock, std::chrono::nanoseconds> endSimulationTime;
 	std::chrono::nanoseconds lastSimulationTime = 0ns;
-	std::chrono::nanoseconds elapsedSimulationTime = 0ns;
 	float averageSimulationTime = 0.0f;
 	uint64_t totalSimulationTime = 0;
 	uint64_t simulationCycleCount = 0;
+	uint64_t tickAllocationStart = 0;
+	uint64_t totalTickAllocations = 0;
 
 	#ifdef DO_LOG_UPDATE_TIMES
 	int64_t lastLogTime = 0;
@@ -130,22 +237,24 @@ void Engine::simulationThreadFunc() {
 	#endif
 
 	// controller statuses
-	float joy0_X, joy0_y;
-	float x, y = 0;
+	sf::Vector2f controls;
+	bool rewinding = false;
+	// every tick is the same length of game time: a networked client predicts with this step,
+	// and the rewind history is sized in ticks, simulationHz of them per second
+	const std::chrono::nanoseconds fixedTickTime = std::chrono::nanoseconds(1s) / simulationHz;
 
-	// compute time between updates based on desired frequency
-	simulationWaitTime = static_cast<uint32_t>(1s / 1ms) / simulationHz;
+	// reused every tick, so capturing doesn't allocate once it's warmed up
+	WorldSnapshot worldSnapshot;
 
 	LOG(INFO) << "Simulation thread: waiting for Engine to become ready";
-	while (!running) {
-		std::this_thread::yield();
-		std::this_thread::sleep_for(10ms);
-	}
+	waitUntilRunning();
 
 	LOG(INFO) << "Starting simulation loop";
+	endSimulationTime = engineClock.now();
+	auto lastBudgetCheck = endSimulationTime;
+	auto nextTick = std::chrono::steady_clock::now();
 	while (running) {
 		startSimulationTime = engineClock.now();
-		elapsedSimulationTime = startSimulationTime - endSimulationTime;
 
 		//compute update time spent
 		totalSimulationTime += lastSimulationTime.count();
@@ -155,62 +264,113 @@ void Engine::simulationThreadFunc() {
 		// log the average time per frame once per second
 		checkLogTime = engineClock.now().time_since_epoch().count();
 		if (checkLogTime - lastLogTime > (1s / 1ns)) {
+			ScopedAllocationTag loggingTag(AllocationTag::Logging);
 			LOG(INFO) << "Average simulation time: " << averageSimulationTime / (1ms / 1ns) << "ms";
+			LOG(INFO) << "Average allocations per tick: "
+				<< static_cast<float>(totalTickAllocations) / static_cast<float>(simulationCycleCount);
 			lastLogTime = checkLogTime;
 		}
 		#endif
-
-		// get current state of controls
-		joy0_X = sf::Joystick::getAxisPosition(0, sf::Joystick::X);
-		joy0_y = sf::Joystick::getAxisPosition(0, sf::Joystick::Y);
-		x = std::abs(joy0_X) < config.deadZone ? 0 : joy0_X;
-		y = std::abs(joy0_y) < config.deadZone ? 0 : joy0_y;
-
-		if (sf::Keyboard::isKeyPressed(sf::Keyboard::Up)) {
-			y += -config.keySpeed;
-		}
-		if (sf::Keyboard::isKeyPressed(sf::Keyboard::Right)) {
-			x += config.keySpeed;
+		// budgets only need checking about once a second
+		if (startSimulationTime - lastBudgetCheck >= 1s) {
+			checkMemoryBudgets();
+			lastBudgetCheck = startSimulationTime;
 		}
-		if (sf::Keyboard::isKeyPressed(sf::Keyboard::Down)) {
-			y += config.keySpeed;
-		}
-		if (sf::Keyboard::isKeyPressed(sf::Keyboard::Left)) {
-			x += -config.keySpeed;
+
+		// count only what the tick itself allocates, not the logging above
+		tickAllocationStart = threadAllocationCount();
+		// last tick's scratch data is done with
+		frameArena().reset();
+
+		if (server) {
+			// the controls come from the client instead, and rewinding would fight its prediction
+			server->receive();
+			const InputRecord input = server->nextInput();
+			controls = sf::Vector2f(dequantizeVelocity(input.x), dequantizeVelocity(input.y));
+			rewinding = false;
+		} else {
+			// get current state of controls
+			controls = readControls();
+			// hold to run time backwards
+			rewinding = sf::Keyboard::isKeyPressed(sf::Keyboard::R);
 		}
 
 		std::unique_lock<std::mutex> spritesLock(spritesMutex);
 
-		player->setVelocityDir(x, y);
+		if (rewinding) {
+			if (history->rewind(worldSnapshot)) {
+				restoreWorld(worldSnapshot);
+			}
+		} else {
+			player->setVelocityDir(controls.x, controls.y);
+			updateWaves(fixedTickTime);
+			updateEnemies(fixedTickTime);
 
-		for (
-			auto& sprite : sprites
-			) {
-			sprite->update(elapsedSimulationTime);
+			for (
+				auto& sprite : sprites
+				) {
+				sprite->update(fixedTickTime);
+			}
+
+			captureWorld(static_cast<uint32_t>(simulationCycleCount), worldSnapshot);
+			history->capture(worldSnapshot);
 		}
 
 		spritesLock.unlock();
 
+		if (server) {
+			server->sendSnapshot(worldSnapshot);
+		}
+
+		totalTickAllocations += threadAllocationCount() - tickAllocationStart;
+
 		// remember how long the above code took, for updateLoop time spent calculation
 		endSimulationTime = engineClock.now();
 		lastSimulationTime = endSimulationTime - startSimulationTime;
-		// sleep long enough to updateLoop at approximately updateHz
-		sf::Int64 timeToWait = simulationWaitTime - lastSimulationTime.count();
-		sf::sleep(sf::microseconds(timeToWait));
+		// absolute deadlines like the client's, so a server consumes inputs as fast as they're sent
+		nextTick += fixedTickTime;
+		const auto now = std::chrono::steady_clock::now();
+		if (now - nextTick > 250ms) {
+			// too far behind to catch up (a breakpoint, a stalled machine), drop the missed ticks
+			nextTick = now;
+		}
+		std::this_thread::sleep_until(nextTick);
 	}
 	LOG(INFO) << "Stopped simulation loop";
+	LOG(INFO) << "Enemy shots fired: " << enemyShotsFired;
+	LOG(INFO) << "Waves started: " << nextWave << " of " << waves.size()
+		<< ", prefetch hits: " << prefetchHits << ", misses: " << prefetchMisses;
+	const AssetStreamer::Stats streamerStats = streamer->getStats();
+	LOG(INFO) << "Asset streaming: " << streamerStats.loads << " loads in " << streamerStats.loadTime << "ms, "
+		<< streamerStats.failures << " failures, " << streamerStats.evictions << " evictions, "
+		<< streamerStats.peakBytes << " bytes peak";
+	if (history->size() > 0) {
+		LOG(INFO) << "Rewind history: " << history->size() << " ticks in " << history->bytesUsed() << " bytes, "
+			<< history->bytesUsed() / history->size() << " bytes per tick";
+	}
 	LOG(INFO) << "Average simulation time: " << averageSimulationTime / (1ms / 1ns) << "ms";
+	if (simulationCycleCount > 0) {
+		LOG(INFO) << "Average allocations per tick: "
+			<< static_cast<float>(totalTickAllocations) / static_cast<float>(simulationCycleCount);
+	}
 }
 
 // runs in its own thread
 void Engine::renderThreadFunc() {
 	LOG(INFO) << "Initializing render thread";
+	el::Helpers::setThreadName(config.threads.render.name);
+	LOG(INFO) << "Render thread: " << applyThreadSettings(config.threads.render);
+	setThreadAllocationTag(AllocationTag::Render);
+
+	FramePacer pacer(
+		config.targetFps,
+		config.justInTime,
+		std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::duration<float, std::milli>(config.jitMargin))
+	);
 
-	std::chrono::time_point<std::chrono::high_resolution_clock> frameStart;
-	std::chrono::nanoseconds lastFrameTime = 0ns;
-	float averageFrameTime = 0.0f;
-	uint64_t totalFrameTime = 0;
-	uint64_t frameCount = 0;
+	uint64_t frameAllocationStart = 0;
+	uint64_t totalFrameAllocations = 0;
+	bool firstFrameShown = false;
 
 	#ifdef DO_LOG_UPDATE_TIMES
 	int64_t lastLogTime = 0;
@@ -218,53 +378,376 @@ void Engine::renderThreadFunc() {
 	#endif
 
 	LOG(INFO) << "Render thread: waiting for Engine to become ready";
-	while (!running) {
-		std::this_thread::yield();
-		std::this_thread::sleep_for(10ms);
-	}
+	waitUntilRunning();
+
+	// a networked game draws what the client thinks is happening
+	std::mutex& drawMutex = client ? client->getSpritesMutex() : spritesMutex;
+	const std::vector<std::shared_ptr<Sprite>>& drawSprites = client ? client->getSprites() : sprites;
 
 	LOG(INFO) << "Starting render loop";
 	while (running) {
-		frameStart = engineClock.now();
-		// compute FPS
-		totalFrameTime += lastFrameTime.count();
-		frameCount++;
-		averageFrameTime = static_cast<float>(totalFrameTime) / static_cast<float>(frameCount);
 		#ifdef DO_LOG_UPDATE_TIMES
-		if (checkLogTime - lastLogTime > (1s / 1ns)) {
-		// log the average time per frame once per second
+		// log the present intervals once per second
 		checkLogTime = engineClock.now().time_since_epoch().count();
-			LOG(INFO) << "Average frame time: " << averageFrameTime / (1ms / 1ns) << "ms";
+		if (checkLogTime - lastLogTime > (1s / 1ns)) {
+			ScopedAllocationTag loggingTag(AllocationTag::Logging);
+			const FramePacer::Stats& stats = pacer.takeIntervalStats();
+			LOG(INFO) << "Present interval: "
+				<< static_cast<float>(stats.averageInterval().count()) / (1ms / 1ns) << "ms avg, "
+				<< static_cast<float>(stats.maxInterval.count()) / (1ms / 1ns) << "ms max, "
+				<< stats.missedDeadlines << " missed";
+			LOG(INFO) << "Average allocations per frame: "
+				<< static_cast<float>(totalFrameAllocations) / static_cast<float>(pacer.getTotalStats().frames);
 			lastLogTime = checkLogTime;
 		}
 		#endif
 
+		// wait for this frame's slot, as late as possible in just-in-time mode
+		pacer.waitToRender();
+		frameAllocationStart = threadAllocationCount();
+		frameArena().reset();
+
+		// capture where everything is, holding the sprites lock only as long as that takes
+		ArenaVector<DrawCommand> drawList{ArenaAllocator<DrawCommand>(frameArena())};
+		std::unique_lock<std::mutex> spritesLock(drawMutex);
+		drawList.reserve(drawSprites.size());
+		for (
+			const auto& sprite : drawSprites
+			) {
+			drawList.push_back({sprite, sprite->getTransform()});
+		}
+		spritesLock.unlock();
+
 		// lock and activate the window
 		std::unique_lock<std::mutex> windowLock(windowMutex);
 		if (window.setActive(true)) {
 			// blank the window to black
 			window.clear(sf::Color::Black);
 			// render all the normal sprites
-			std::unique_lock<std::mutex> spritesLock(spritesMutex);
 			for (
-				const auto& sprite : sprites
+				const auto& command : drawList
 				) {
-				window.draw(*sprite);
+				command.sprite->drawWithTransform(window, command.transform);
 			}
-			spritesLock.unlock();
 			// update the window
 			window.display();
+			if (!firstFrameShown) {
+				firstFrameShown = true;
+				LOG(INFO) << "Time to first frame: "
+					<< static_cast<float>((std::chrono::steady_clock::now() - startupTime) / 1us) / 1000.0f << "ms";
+			}
 		} else {
 			LOG(INFO) << "Failed to get window context for rendering.";
 		}
 		// release the lock
 		windowLock.unlock();
 
-		// remember how long the whole loop took, for FPS calculation
-		lastFrameTime = engineClock.now() - frameStart;
+		totalFrameAllocations += threadAllocationCount() - frameAllocationStart;
+		pacer.presented();
 	}
 	LOG(INFO) << "Stopped render loop";
-	LOG(INFO) << "Average frame time: " << averageFrameTime / (1ms / 1ns) << "ms";
+	const FramePacer::Stats& stats = pacer.getTotalStats();
+	LOG(INFO) << "Frames presented: " << stats.frames << ", missed deadlines: " << stats.missedDeadlines;
+	LOG(INFO) << "Average present interval: " << static_cast<float>(stats.averageInterval().count()) / (1ms / 1ns) << "ms";
+	if (stats.frames > 0) {
+		LOG(INFO) << "Present interval range: "
+			<< static_cast<float>(stats.minInterval.count()) / (1ms / 1ns) << "ms - "
+			<< static_cast<float>(stats.maxInterval.count()) / (1ms / 1ns) << "ms";
+		LOG(INFO) << "Average allocations per frame: "
+			<< static_cast<float>(totalFrameAllocations) / static_cast<float>(stats.frames);
+	}
+}
+
+// runs in its own thread
+void Engine::clientThreadFunc() {
+	LOG(INFO) << "Initializing client thread";
+	el::Helpers::setThreadName(config.threads.client.name);
+	LOG(INFO) << "Client thread: " << applyThreadSettings(config.threads.client);
+	setThreadAllocationTag(AllocationTag::Entities);
+
+	const std::chrono::nanoseconds tickTime = std::chrono::nanoseconds(1s) / simulationHz;
+
+	#ifdef DO_LOG_UPDATE_TIMES
+	int64_t lastLogTime = 0;
+	int64_t checkLogTime = 0;
+	#endif
+
+	LOG(INFO) << "Client thread: waiting for Engine to become ready";
+	waitUntilRunning();
+
+	LOG(INFO) << "Starting client loop";
+	auto nextTick = std::chrono::steady_clock::now();
+	while (running) {
+		#ifdef DO_LOG_UPDATE_TIMES
+		// log the connection quality once per second
+		checkLogTime = engineClock.now().time_since_epoch().count();
+		if (checkLogTime - lastLogTime > (1s / 1ns)) {
+			ScopedAllocationTag loggingTag(AllocationTag::Logging);
+			LOG(INFO) << "Round trip: " << client->getStats().lastRoundTrip << "ms";
+			lastLogTime = checkLogTime;
+		}
+		#endif
+
+		const sf::Vector2f controls = readControls();
+		client->tick(controls.x, controls.y);
+
+		// absolute deadlines, so the client keeps the same tick rate as the server
+		nextTick += tickTime;
+		std::this_thread::sleep_until(nextTick);
+	}
+	LOG(INFO) << "Stopped client loop";
+}
+
+sf::Vector2f Engine::readControls() const {
+	const float joy0_X = sf::Joystick::getAxisPosition(0, sf::Joystick::X);
+	const float joy0_y = sf::Joystick::getAxisPosition(0, sf::Joystick::Y);
+	float x = std::abs(joy0_X) < config.deadZone ? 0 : joy0_X;
+	float y = std::abs(joy0_y) < config.deadZone ? 0 : joy0_y;
+
+	if (sf::Keyboard::isKeyPressed(sf::Keyboard::Up)) {
+		y += -config.keySpeed;
+	}
+	if (sf::Keyboard::isKeyPressed(sf::Keyboard::Right)) {
+		x += config.keySpeed;
+	}
+	if (sf::Keyboard::isKeyPressed(sf::Keyboard::Down)) {
+		y += config.keySpeed;
+	}
+	if (sf::Keyboard::isKeyPressed(sf::Keyboard::Left)) {
+		x += -config.keySpeed;
+	}
+	return sf::Vector2f(x, y);
+}
+
+void Engine::addToWorld(const std::shared_ptr<Sprite>& sprite) {
+	sprites.push_back(sprite);
+	entityIds.push_back(nextEntityId++);
+}
+
+void Engine::removeFromWorld(const ArenaVector<const Sprite*>& ships) {
+	if (ships.empty()) {
+		return;
+	}
+	const auto isGone = [&ships](const std::shared_ptr<Sprite>& sprite) {
+		return std::find(ships.begin(), ships.end(), sprite.get()) != ships.end();
+	};
+
+	// keep the rest in order, so the ids stay sorted and the client's startup sprites keep their indexes
+	size_t kept = 0;
+	for (size_t i = 0; i < sprites.size(); i++) {
+		if (isGone(sprites[i])) {
+			continue;
+		}
+		if (kept != i) {
+			sprites[kept] = std::move(sprites[i]);
+			entityIds[kept] = entityIds[i];
+		}
+		kept++;
+	}
+	sprites.erase(sprites.begin() + static_cast<std::ptrdiff_t>(kept), sprites.end());
+	entityIds.erase(entityIds.begin() + static_cast<std::ptrdiff_t>(kept), entityIds.end());
+
+	// backwards, so the ship swapped into a removed one's place has already been looked at
+	for (auto& group : enemyGroups) {
+		for (size_t i = group.ships.size(); i-- > 0;) {
+			if (isGone(group.ships[i])) {
+				group.batch->remove(static_cast<uint32_t>(i));
+				group.ships[i] = std::move(group.ships.back());
+				group.ships.pop_back();
+			}
+		}
+	}
+	waveShips.erase(std::remove_if(waveShips.begin(), waveShips.end(), isGone), waveShips.end());
+}
+
+void Engine::addEnemy(const std::shared_ptr<Sprite>& ship) {
+	const std::string& behaviorName = ship->getBehavior();
+	if (behaviorName.empty()) {
+		return;
+	}
+	const BehaviorProgram* program = behaviors.find(behaviorName);
+	if (program == nullptr) {
+		LOG(ERROR) << "Unknown behavior '" << behaviorName << "', enemy will stay put";
+		return;
+	}
+	auto groupIter = std::find_if(enemyGroups.begin(), enemyGroups.end(), [program](const EnemyGroup& group) {
+		return &group.batch->getProgram() == program;
+	});
+	if (groupIter == enemyGroups.end()) {
+		enemyGroups.push_back({std::make_unique<BehaviorBatch>(*program), {}});
+		groupIter = enemyGroups.end() - 1;
+	}
+	groupIter->batch->add(ship->getPosition().x, ship->getPosition().y);
+	groupIter->ships.push_back(ship);
+}
+
+void Engine::updateEnemies(const std::chrono::nanoseconds& elapsed) {
+	const float elapsedSeconds = static_cast<float>(elapsed.count()) / (1s / 1ns);
+	const sf::Vector2f& target = player->getPosition();
+	for (auto& group : enemyGroups) {
+		BehaviorBatch& batch = *group.batch;
+		for (size_t i = 0; i < group.ships.size(); i++) {
+			const sf::Vector2f& position = group.ships[i]->getPosition();
+			batch.x[i] = position.x;
+			batch.y[i] = position.y;
+		}
+		batch.evaluate(elapsedSeconds, target.x, target.y);
+		for (size_t i = 0; i < group.ships.size(); i++) {
+			group.ships[i]->setVelocityDir(batch.dirX[i], batch.dirY[i]);
+		}
+		enemyShotsFired += batch.fired.size();
+	}
+}
+
+void Engine::updateWaves(const std::chrono::nanoseconds& elapsed) {
+	// well past the edge, so even the biggest ships are out of sight
+	const float margin = static_cast<float>(renderHeight) / 4.0f;
+	ArenaVector<const Sprite*> gone{ArenaAllocator<const Sprite*>(frameArena())};
+	for (const auto& ship : waveShips) {
+		const sf::Vector2f& position = ship->getPosition();
+		if (
+			position.x < -margin || position.x > static_cast<float>(renderWidth) + margin ||
+			position.y < -margin || position.y > static_cast<float>(renderHeight) + margin
+		) {
+			gone.push_back(ship.get());
+		}
+	}
+	removeFromWorld(gone);
+
+	if (nextWave >= waves.size() && waveShips.empty()) {
+		return;
+	}
+	waveTimer -= elapsed;
+	if (waveTimer > 0ns) {
+		return;
+	}
+
+	// the wave in play is over
+	if (!waveShips.empty()) {
+		gone.clear();
+		for (const auto& ship : waveShips) {
+			gone.push_back(ship.get());
+		}
+		removeFromWorld(gone);
+	}
+	if (nextWave >= waves.size()) {
+		return;
+	}
+
+	// never wait on a load here, a wave that isn't ready just starts a little late
+	const Wave& wave = waves[nextWave];
+	ArenaVector<std::shared_ptr<const Sprite>> prototypes{ArenaAllocator<std::shared_ptr<const Sprite>>(frameArena())};
+	bool ready = true;
+	for (const auto& name : wave.assets) {
+		prototypes.push_back(streamer->find(name));
+		if (!prototypes.back() && !streamer->hasFailed(name)) {
+			ready = false;
+			streamer->prefetch(name);
+		}
+		if (!waveDeferred) {
+			prototypes.back() ? prefetchHits++ : prefetchMisses++;
+		}
+	}
+	if (!ready) {
+		if (!waveDeferred) {
+			ScopedAllocationTag loggingTag(AllocationTag::Logging);
+			LOG(WARNING) << "Wave '" << wave.name << "' is due but still loading, deferring it";
+			waveDeferred = true;
+			waveDeferredSince = std::chrono::steady_clock::now();
+		}
+		return;
+	}
+
+	for (size_t row = 0; row < wave.spawns.size(); row++) {
+		const WaveSpawn& spawn = wave.spawns[row];
+		const auto assetIndex = static_cast<size_t>(
+			std::find(wave.assets.begin(), wave.assets.end(), spawn.sprite) - wave.assets.begin()
+		);
+		const std::shared_ptr<const Sprite>& prototype = prototypes[assetIndex];
+		if (!prototype) {
+			continue;
+		}
+		// spread each group across its own row at the top
+		for (uint32_t i = 0; i < spawn.count; i++) {
+			auto ship = std::make_shared<Sprite>(*prototype);
+			ship->setPosition(
+				static_cast<float>(renderWidth * (i + 1)) / static_cast<float>(spawn.count + 1),
+				static_cast<float>(renderHeight / 8) + static_cast<float>(row) * 60.0f
+			);
+			addToWorld(ship);
+			addEnemy(ship);
+			waveShips.push_back(ship);
+		}
+	}
+
+	{
+		ScopedAllocationTag loggingTag(AllocationTag::Logging);
+		if (waveDeferred) {
+			LOG(INFO) << "Wave '" << wave.name << "' started, "
+				<< static_cast<float>((std::chrono::steady_clock::now() - waveDeferredSince) / 1us) / 1000.0f << "ms late";
+		} else {
+			LOG(INFO) << "Wave '" << wave.name << "' started";
+		}
+	}
+	waveDeferred = false;
+	waveTimer = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::duration<float>(wave.duration));
+	nextWave++;
+	streamWaves(nextWave);
+}
+
+void Engine::streamWaves(const size_t first) {
+	std::vector<std::string> pinned;
+	// the wave in play can still be rewound into, so keep it as well as the upcoming ones
+	const size_t start = first > 0 ? first - 1 : 0;
+	const size_t end = std::min(waves.size(), first + config.streaming.prefetchWaves);
+	for (size_t wave = start; wave < end; wave++) {
+		for (const auto& name : waves[wave].assets) {
+			if (wave >= first) {
+				streamer->prefetch(name);
+			}
+			pinned.push_back(name);
+		}
+	}
+	streamer->pin(pinned);
+}
+
+void Engine::captureWorld(const uint32_t tick, WorldSnapshot& snapshot) const {
+	snapshot.tick = tick;
+	snapshot.entities.resize(sprites.size());
+	for (size_t i = 0; i < sprites.size(); i++) {
+		const Sprite& sprite = *sprites[i];
+		snapshot.entities[i] = {
+			entityIds[i],
+			quantizePosition(sprite.getPosition().x),
+			quantizePosition(sprite.getPosition().y),
+			quantizeRotation(sprite.getRotation()),
+			quantizeVelocity(sprite.getVelocityDir().x),
+			quantizeVelocity(sprite.getVelocityDir().y),
+			quantizeSpeed(sprite.getSpeed())
+		};
+	}
+}
+
+void Engine::restoreWorld(const WorldSnapshot& snapshot) {
+	// both are sorted by id, so walk them together, ships spawned since keep their state
+	size_t index = 0;
+	for (const auto& entity : snapshot.entities) {
+		while (index < sprites.size() && entityIds[index] < entity.id) {
+			index++;
+		}
+		if (index == sprites.size()) {
+			break;
+		}
+		// despawned since
+		if (entityIds[index] != entity.id) {
+			continue;
+		}
+		Sprite& sprite = *sprites[index];
+		sprite.setPosition(dequantizePosition(entity.x), dequantizePosition(entity.y));
+		sprite.setRotation(dequantizeRotation(entity.rotation));
+		sprite.setVelocityDir(dequantizeVelocity(entity.velocityX), dequantizeVelocity(entity.velocityY));
+		sprite.setSpeed(dequantizeSpeed(entity.speed));
+	}
 }
 
 void Engine::processEvents() {
@@ -333,6 +816,9 @@ void Engine::dumpSystemInfo() const {
 	LOG(INFO) << "JAGE " << JAGE_VERSION_MAJOR << "." << JAGE_VERSION_MINOR << "." << JAGE_VERSION_REVISION;
 	LOG(INFO) << "Built at " << __TIME__ << " on " << __DATE__;
 
+	// and the hardware we're on
+	LOG(INFO) << "CPU: " << describeCpuTopology();
+
 	// and SFML's info
 	LOG(INFO) << "Using SFML " << SFML_VERSION_MAJOR << "." << SFML_VERSION_MINOR << "." << SFML_VERSION_PATCH;
 
@@ -358,19 +844,72 @@ void Engine::dumpSystemInfo() const {
 	#endif
 }
 
+void Engine::dumpMemoryStats() const {
+	if (!allocationTrackingEnabled()) {
+		LOG(INFO) << "Allocation tracking disabled in this build";
+		return;
+	}
+	LOG(INFO) << "Heap usage by subsystem:";
+	for (size_t tag = 0; tag < ALLOCATION_TAG_COUNT; tag++) {
+		const AllocationCounters& counters = allocationCounters(static_cast<AllocationTag>(tag));
+		LOG(INFO) << "\t" << allocationTagToString(static_cast<AllocationTag>(tag))
+			<< ": " << counters.allocations << " allocations, "
+			<< counters.frees << " frees, "
+			<< counters.liveBytes << " bytes live, "
+			<< counters.peakBytes << " bytes peak";
+	}
+}
+
+void Engine::checkMemoryBudgets() {
+	for (size_t tag = 0; tag < ALLOCATION_TAG_COUNT; tag++) {
+		if (config.memoryBudgets[tag] <= 0.0f) {
+			continue;
+		}
+		const auto budget = static_cast<int64_t>(config.memoryBudgets[tag] * 1024 * 1024);
+		const int64_t liveBytes = allocationCounters(static_cast<AllocationTag>(tag)).liveBytes;
+		if (liveBytes > budget && !overBudget[tag]) {
+			ScopedAllocationTag loggingTag(AllocationTag::Logging);
+			LOG(WARNING) << "Memory budget exceeded for " << allocationTagToString(static_cast<AllocationTag>(tag))
+				<< ": " << liveBytes << " bytes live, budget " << budget << " bytes";
+		}
+		overBudget[tag] = liveBytes > budget;
+	}
+}
+
+void Engine::dumpNetworkStats(const float seconds) const {
+	const ChannelStats& serverStats = server->getChannelStats();
+	const ChannelStats& clientStats = client->getChannelStats();
+	const GameClient::Stats& stats = client->getStats();
+	LOG(INFO) << "Network stats over " << seconds << "s:";
+	LOG(INFO) << "\tserver to client: " << static_cast<float>(serverStats.bytesSent) / seconds << " bytes/s in "
+		<< static_cast<float>(serverStats.packetsSent) / seconds << " packets/s, " << serverStats.packetsDropped << " dropped";
+	LOG(INFO) << "\tclient to server: " << static_cast<float>(clientStats.bytesSent) / seconds << " bytes/s in "
+		<< static_cast<float>(clientStats.packetsSent) / seconds << " packets/s, " << clientStats.packetsDropped << " dropped";
+	LOG(INFO) << "\tsnapshots: " << stats.snapshotsReceived << " applied, " << stats.snapshotsRejected << " rejected";
+	LOG(INFO) << "\tinputs lost: " << server->getInputsLost();
+	if (stats.snapshotsReceived > 0) {
+		LOG(INFO) << "\tround trip: " << stats.totalRoundTrip / static_cast<float>(stats.snapshotsReceived) << "ms avg, "
+			<< stats.maxRoundTrip << "ms max";
+	}
+	if (stats.predictionChecks > 0) {
+		LOG(INFO) << "\tprediction error: " << stats.totalPredictionError / static_cast<float>(stats.predictionChecks)
+			<< "px avg, " << stats.maxPredictionError << "px max";
+	}
+}
+
 void Engine::readConfig() {
-	std::string configFilename = data_dir + "/config.yaml";
-	LOG(INFO) << "Reading config from '" << configFilename << "'";
+	std::string configFilename = "config.yaml";
+	LOG(INFO) << "Reading config from '" << configFilename << "' in " << assets.getLocation();
 	try {
-		YAML::Node yamlConfig = YAML::LoadFile(configFilename);
-		config.name = yamlConfig["name"].as<std::string>(game);
-		config.width = yamlConfig["width"].as<uint32_t>(config.width);
-		config.height = yamlConfig["height"].as<uint32_t>(config.height);
-		config.fullscreen = yamlConfig["fullscreen"].as<bool>(config.fullscreen);
-		config.useDesktopSize = yamlConfig["useDesktopSize"].as<bool>(config.useDesktopSize);
-		config.vsync = yamlConfig["vsync"].as<bool>(config.vsync);
-		config.deadZone = yamlConfig["deadzone"].as<float>(config.deadZone);
-		config.keySpeed = yamlConfig["keySpeed"].as<float>(config.keySpeed);
+		const YAML::Node yamlConfig = assets.loadYAML(configFilename);
+		config.name = game;
+		SchemaErrors errors;
+		if (!parseEngineConfig(yamlConfig, config, SchemaPath{nullptr, configFilename.c_str()}, errors)) {
+			for (const auto& problem : errors.get()) {
+				LOG(WARNING) << problem;
+			}
+			LOG(WARNING) << "Using the defaults for the " << errors.get().size() << " problem(s) in '" << configFilename << "'";
+		}
 	} catch (YAML::Exception& e) {
 		LOG(ERROR) << "YAML Exception: " << e.msg;
 		LOG(ERROR) << "Can't load '" << configFilename << "', using sane defaults";
@@ -384,6 +923,30 @@ void Engine::readConfig() {
 	LOG(INFO) << "\tvsync = " << (config.vsync ? "true" : "false");
 	LOG(INFO) << "\tdeadZone = " << config.deadZone;
 	LOG(INFO) << "\tkeySpeed = " << config.keySpeed;
+	LOG(INFO) << "\trewindSeconds = " << config.rewindSeconds;
+	LOG(INFO) << "\ttargetFps = " << config.targetFps;
+	LOG(INFO) << "\tjustInTime = " << (config.justInTime ? "true" : "false");
+	LOG(INFO) << "\tjitMargin = " << config.jitMargin << "ms";
+	LOG(INFO) << "\tthreads.main = " << threadSettingsToString(config.threads.main);
+	LOG(INFO) << "\tthreads.simulation = " << threadSettingsToString(config.threads.simulation);
+	LOG(INFO) << "\tthreads.render = " << threadSettingsToString(config.threads.render);
+	LOG(INFO) << "\tthreads.worker = " << threadSettingsToString(config.threads.worker);
+	LOG(INFO) << "\tthreads.client = " << threadSettingsToString(config.threads.client);
+	LOG(INFO) << "\tthreads.streamer = " << threadSettingsToString(config.threads.streamer);
+	LOG(INFO) << "\tstreaming.memoryCap = " << config.streaming.memoryCap << "MiB";
+	LOG(INFO) << "\tstreaming.prefetchWaves = " << config.streaming.prefetchWaves;
+	LOG(INFO) << "\tnetwork.enabled = " << (config.network.enabled ? "true" : "false");
+	LOG(INFO) << "\tnetwork.port = " << config.network.port;
+	LOG(INFO) << "\tnetwork.latency = " << config.network.conditions.latency << "ms";
+	LOG(INFO) << "\tnetwork.jitter = " << config.network.conditions.jitter << "ms";
+	LOG(INFO) << "\tnetwork.loss = " << config.network.conditions.loss;
+	LOG(INFO) << "\tnetwork.snapshotInterval = " << config.network.snapshotInterval;
+	LOG(INFO) << "\tnetwork.inputRedundancy = " << config.network.inputRedundancy;
+	LOG(INFO) << "\tnetwork.interpolationDelay = " << config.network.interpolationDelay << "ms";
+	for (size_t tag = 0; tag < ALLOCATION_TAG_COUNT; tag++) {
+		LOG(INFO) << "\tmemoryBudgets." << allocationTagToString(static_cast<AllocationTag>(tag))
+			<< " = " << config.memoryBudgets[tag] << "MiB";
+	}
 }
 
 void Engine::createWindow(const bool shouldFullscreen) {
@@ -0,0 +1,105 @@
+#include <FramePacer.hpp>
+
+std::chrono::nanoseconds FramePacer::Stats::averageInterval() const {
+	if (frames == 0) {
+		return 0ns;
+	}
+	return totalInterval / static_cast<int64_t>(frames);
+}
+
+FramePacer::FramePacer(
+	const uint32_t targetFps,
+	const bool justInTime,
+	const std::chrono::nanoseconds jitMargin,
+	const std::chrono::nanoseconds spinThreshold
+) :
+	framePeriod(targetFps > 0 ? std::chrono::nanoseconds(1s) / targetFps : 0ns),
+	justInTime(justInTime),
+	jitMargin(jitMargin),
+	spinThreshold(spinThreshold) {
+}
+
+void FramePacer::waitToRender() {
+	const clock::time_point now = clock::now();
+	if (!started) {
+		started = true;
+		deadline = now + framePeriod;
+		lastPresent = now;
+	}
+	if (framePeriod > 0ns) {
+		if (justInTime) {
+			// start as late as possible and still present by the deadline,
+			// so the world is sampled as close to the present as we can manage
+			waitUntil(deadline - renderEstimate - jitMargin);
+		} else {
+			// start at the beginning of this frame's slot
+			waitUntil(deadline - framePeriod);
+		}
+	}
+	renderStart = clock::now();
+}
+
+void FramePacer::presented() {
+	const clock::time_point now = clock::now();
+
+	// smooth the render cost so one slow frame doesn't throw off the next start time
+	renderEstimate = (renderEstimate * 7 + (now - renderStart)) / 8;
+	if (renderEstimate > framePeriod) {
+		renderEstimate = framePeriod;
+	}
+
+	// with v-sync the present can land a little past our deadline,
+	// only count it as missed if it slipped halfway into the next slot
+	const bool missed = framePeriod > 0ns && now > deadline + framePeriod / 2;
+	const std::chrono::nanoseconds interval = now - lastPresent;
+	record(totalStats, interval, missed);
+	record(intervalStats, interval, missed);
+	lastPresent = now;
+
+	deadline += framePeriod;
+	if (deadline < now) {
+		// too far behind, resync instead of rushing out frames to catch up
+		deadline = now + framePeriod;
+	}
+}
+
+const FramePacer::Stats& FramePacer::getTotalStats() const {
+	return totalStats;
+}
+
+FramePacer::Stats FramePacer::takeIntervalStats() {
+	Stats stats = intervalStats;
+	intervalStats = Stats();
+	return stats;
+}
+
+std::chrono::nanoseconds FramePacer::getFramePeriod() const {
+	return framePeriod;
+}
+
+std::chrono::nanoseconds FramePacer::getRenderEstimate() const {
+	return renderEstimate;
+}
+
+void FramePacer::waitUntil(const clock::time_point& wakeTime) const {
+	if (wakeTime - clock::now() > spinThreshold) {
+		std::this_thread::sleep_until(wakeTime - spinThreshold);
+	}
+	while (clock::now() < wakeTime) {
+		std::this_thread::yield();
+	}
+}
+
+void FramePacer::record(Stats& stats, const std::chrono::nanoseconds& interval, const bool missed) {
+	stats.frames++;
+	if (missed) {
+		stats.missedDeadlines++;
+	}
+	stats.totalInterval += interval;
+	if (interval < stats.minInterval) {
+		stats.minInterval = interval;
+	}
+	if (interval > stats.maxInterval) {
+		stats.maxInterval = interval;
+	}
+}
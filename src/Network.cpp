@@ -0,0 +1,212 @@
+#include <Network.hpp>
+
+#include <algorithm>
+
+namespace {
+
+// more than enough for a few frames at the worst latency we'd simulate
+const size_t DELAY_QUEUE_SIZE = 256;
+// type, send time, ack tick, input count
+const size_t INPUT_HEADER_SIZE = 1 + 4 + 4 + 1;
+const size_t INPUT_RECORD_SIZE = 4 + 2 + 2;
+// type, last input, echo time
+const size_t SNAPSHOT_HEADER_SIZE = 1 + 4 + 4 + 4 + 4;
+
+void writeUint16(std::vector<uint8_t>& out, const uint16_t value) {
+	out.push_back(static_cast<uint8_t>(value));
+	out.push_back(static_cast<uint8_t>(value >> 8));
+}
+
+void writeUint32(std::vector<uint8_t>& out, const uint32_t value) {
+	for (size_t byte = 0; byte < 4; byte++) {
+		out.push_back(static_cast<uint8_t>(value >> (8 * byte)));
+	}
+}
+
+uint16_t readUint16(const uint8_t* data) {
+	return static_cast<uint16_t>(data[0] | data[1] << 8);
+}
+
+uint32_t readUint32(const uint8_t* data) {
+	return static_cast<uint32_t>(data[0])
+		| static_cast<uint32_t>(data[1]) << 8
+		| static_cast<uint32_t>(data[2]) << 16
+		| static_cast<uint32_t>(data[3]) << 24;
+}
+
+}
+
+UdpChannel::UdpChannel(const NetworkConditions& _conditions, const uint32_t seed) :
+	conditions(_conditions),
+	random(seed),
+	delayed(DELAY_QUEUE_SIZE),
+	receiveBuffer(sf::UdpSocket::MaxDatagramSize) {
+	socket.setBlocking(false);
+}
+
+bool UdpChannel::bind(const unsigned short port) {
+	// port 0 is sf::Socket::AnyPort, letting the OS pick
+	return socket.bind(port, sf::IpAddress::LocalHost) == sf::Socket::Done;
+}
+
+unsigned short UdpChannel::getLocalPort() const {
+	return socket.getLocalPort();
+}
+
+void UdpChannel::setPeer(const sf::IpAddress& address, const unsigned short port) {
+	peerAddress = address;
+	peerPort = port;
+}
+
+bool UdpChannel::hasPeer() const {
+	return peerPort != 0;
+}
+
+void UdpChannel::send(const std::vector<uint8_t>& data) {
+	if (!hasPeer()) {
+		return;
+	}
+	if (unit(random) < conditions.loss) {
+		stats.packetsDropped++;
+		return;
+	}
+	const float delay = conditions.latency + conditions.jitter * unit(random);
+	if (delay <= 0.0f) {
+		sendNow(data);
+		return;
+	}
+	for (auto& packet : delayed) {
+		if (!packet.queued) {
+			packet.queued = true;
+			packet.due = clock::now()
+				+ std::chrono::duration_cast<clock::duration>(std::chrono::duration<float, std::milli>(delay));
+			// assign keeps the slot's capacity, so this stops allocating once warmed up
+			packet.data.assign(data.begin(), data.end());
+			return;
+		}
+	}
+	stats.packetsDropped++;
+}
+
+bool UdpChannel::receive(std::vector<uint8_t>& data) {
+	flush();
+	std::size_t received = 0;
+	sf::IpAddress sender;
+	unsigned short senderPort = 0;
+	if (socket.receive(receiveBuffer.data(), receiveBuffer.size(), received, sender, senderPort) != sf::Socket::Done) {
+		return false;
+	}
+	if (!hasPeer()) {
+		setPeer(sender, senderPort);
+	} else if (sender != peerAddress || senderPort != peerPort) {
+		// not who we're talking to
+		return false;
+	}
+	stats.packetsReceived++;
+	stats.bytesReceived += received;
+	data.assign(receiveBuffer.begin(), receiveBuffer.begin() + static_cast<std::ptrdiff_t>(received));
+	return true;
+}
+
+void UdpChannel::flush() {
+	const clock::time_point now = clock::now();
+	for (auto& packet : delayed) {
+		if (packet.queued && packet.due <= now) {
+			sendNow(packet.data);
+			packet.queued = false;
+		}
+	}
+}
+
+const ChannelStats& UdpChannel::getStats() const {
+	return stats;
+}
+
+void UdpChannel::sendNow(const std::vector<uint8_t>& data) {
+	if (socket.send(data.data(), data.size(), peerAddress, peerPort) == sf::Socket::Done) {
+		stats.packetsSent++;
+		stats.bytesSent += data.size();
+	} else {
+		stats.packetsDropped++;
+	}
+}
+
+void encodeInputBatch(
+	const uint32_t sendTime,
+	const uint32_t ackTick,
+	const std::vector<InputRecord>& inputs,
+	std::vector<uint8_t>& out
+) {
+	out.clear();
+	out.push_back(MESSAGE_INPUT);
+	writeUint32(out, sendTime);
+	writeUint32(out, ackTick);
+	const size_t count = std::min<size_t>(inputs.size(), 255);
+	out.push_back(static_cast<uint8_t>(count));
+	// newest last
+	for (size_t i = inputs.size() - count; i < inputs.size(); i++) {
+		writeUint32(out, inputs[i].sequence);
+		writeUint16(out, static_cast<uint16_t>(inputs[i].x));
+		writeUint16(out, static_cast<uint16_t>(inputs[i].y));
+	}
+}
+
+bool decodeInputBatch(
+	const std::vector<uint8_t>& data,
+	uint32_t& sendTime,
+	uint32_t& ackTick,
+	std::vector<InputRecord>& inputs
+) {
+	if (data.size() < INPUT_HEADER_SIZE || data[0] != MESSAGE_INPUT) {
+		return false;
+	}
+	sendTime = readUint32(&data[1]);
+	ackTick = readUint32(&data[5]);
+	const size_t count = data[9];
+	if (data.size() != INPUT_HEADER_SIZE + count * INPUT_RECORD_SIZE) {
+		return false;
+	}
+	inputs.resize(count);
+	const uint8_t* in = &data[INPUT_HEADER_SIZE];
+	for (auto& input : inputs) {
+		input.sequence = readUint32(in);
+		input.x = static_cast<int16_t>(readUint16(in + 4));
+		input.y = static_cast<int16_t>(readUint16(in + 6));
+		in += INPUT_RECORD_SIZE;
+	}
+	return true;
+}
+
+void encodeSnapshotHeader(
+	const uint32_t lastInput,
+	const uint32_t repeatedTicks,
+	const uint32_t echoTime,
+	const uint32_t heldTime,
+	std::vector<uint8_t>& out
+) {
+	out.clear();
+	out.push_back(MESSAGE_SNAPSHOT);
+	writeUint32(out, lastInput);
+	writeUint32(out, repeatedTicks);
+	writeUint32(out, echoTime);
+	writeUint32(out, heldTime);
+}
+
+bool decodeSnapshotHeader(
+	const std::vector<uint8_t>& data,
+	uint32_t& lastInput,
+	uint32_t& repeatedTicks,
+	uint32_t& echoTime,
+	uint32_t& heldTime,
+	size_t& payloadOffset
+) {
+	if (data.size() < SNAPSHOT_HEADER_SIZE || data[0] != MESSAGE_SNAPSHOT) {
+		return false;
+	}
+	lastInput = readUint32(&data[1]);
+	repeatedTicks = readUint32(&data[5]);
+	echoTime = readUint32(&data[9]);
+	heldTime = readUint32(&data[13]);
+	payloadOffset = SNAPSHOT_HEADER_SIZE;
+	return true;
+}
@@ -0,0 +1,230 @@
+#include <Pack.hpp>
+
+#include <algorithm>
+#include <fstream>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+const char MAGIC[4] = {'J', 'P', 'A', 'K'};
+// magic, version, entry count, table of contents offset
+const size_t HEADER_SIZE = 4 + 4 + 4 + 8;
+
+uint64_t readUint(const char* data, const size_t bytes) {
+	uint64_t value = 0;
+	for (size_t byte = 0; byte < bytes; byte++) {
+		value |= static_cast<uint64_t>(static_cast<uint8_t>(data[byte])) << (8 * byte);
+	}
+	return value;
+}
+
+void writeUint(std::vector<char>& out, const uint64_t value, const size_t bytes) {
+	for (size_t byte = 0; byte < bytes; byte++) {
+		out.push_back(static_cast<char>(static_cast<uint8_t>(value >> (8 * byte))));
+	}
+}
+
+}
+
+PackFile::~PackFile() {
+	close();
+}
+
+bool PackFile::open(const std::string& _fileName) {
+	close();
+	fileName = _fileName;
+
+	#ifdef _WIN32
+	HANDLE file = CreateFileA(
+		fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, nullptr
+	);
+	if (file == INVALID_HANDLE_VALUE) {
+		return false;
+	}
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+		CloseHandle(file);
+		return false;
+	}
+	HANDLE fileMapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (fileMapping == nullptr) {
+		CloseHandle(file);
+		return false;
+	}
+	const void* view = MapViewOfFile(fileMapping, FILE_MAP_READ, 0, 0, 0);
+	if (view == nullptr) {
+		CloseHandle(fileMapping);
+		CloseHandle(file);
+		return false;
+	}
+	fileHandle = file;
+	mappingHandle = fileMapping;
+	mapping = static_cast<const char*>(view);
+	mappingSize = static_cast<size_t>(fileSize.QuadPart);
+	#else
+	const int file = ::open(fileName.c_str(), O_RDONLY);
+	if (file < 0) {
+		return false;
+	}
+	struct stat fileStat {};
+	if (fstat(file, &fileStat) != 0 || fileStat.st_size == 0) {
+		::close(file);
+		return false;
+	}
+	void* view = mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+	// the mapping keeps its own reference to the file
+	::close(file);
+	if (view == MAP_FAILED) {
+		return false;
+	}
+	mapping = static_cast<const char*>(view);
+	mappingSize = static_cast<size_t>(fileStat.st_size);
+	#endif
+
+	if (!readTableOfContents()) {
+		close();
+		return false;
+	}
+	return true;
+}
+
+void PackFile::close() {
+	if (mapping == nullptr) {
+		return;
+	}
+	#ifdef _WIN32
+	UnmapViewOfFile(mapping);
+	CloseHandle(mappingHandle);
+	CloseHandle(fileHandle);
+	mappingHandle = nullptr;
+	fileHandle = nullptr;
+	#else
+	munmap(const_cast<char*>(mapping), mappingSize);
+	#endif
+	mapping = nullptr;
+	mappingSize = 0;
+	entries.clear();
+}
+
+bool PackFile::isOpen() const {
+	return mapping != nullptr;
+}
+
+bool PackFile::find(const std::string& name, const char*& data, size_t& size) const {
+	const auto entryIter = std::lower_bound(entries.begin(), entries.end(), name, [](const Entry& entry, const std::string& key) {
+		return entry.name < key;
+	});
+	if (entryIter == entries.end() || entryIter->name != name) {
+		return false;
+	}
+	data = mapping + entryIter->offset;
+	size = static_cast<size_t>(entryIter->size);
+	return true;
+}
+
+const std::vector<PackFile::Entry>& PackFile::getEntries() const {
+	return entries;
+}
+
+size_t PackFile::getSize() const {
+	return mappingSize;
+}
+
+bool PackFile::readTableOfContents() {
+	if (mappingSize < HEADER_SIZE || !std::equal(MAGIC, MAGIC + 4, mapping) || readUint(mapping + 4, 4) != VERSION) {
+		return false;
+	}
+	const auto count = static_cast<size_t>(readUint(mapping + 8, 4));
+	uint64_t position = readUint(mapping + 12, 8);
+	// a name length and an offset & size even for an empty name, so a corrupt count can't reserve gigabytes
+	const size_t minimumEntrySize = 2 + 16;
+	if (position > mappingSize || count > (mappingSize - position) / minimumEntrySize) {
+		return false;
+	}
+	entries.reserve(count);
+	for (size_t i = 0; i < count; i++) {
+		if (position > mappingSize || mappingSize - position < 2) {
+			return false;
+		}
+		const auto nameLength = static_cast<size_t>(readUint(mapping + position, 2));
+		position += 2;
+		if (mappingSize - position < nameLength + 16) {
+			return false;
+		}
+		Entry entry;
+		entry.name.assign(mapping + position, nameLength);
+		position += nameLength;
+		entry.offset = readUint(mapping + position, 8);
+		entry.size = readUint(mapping + position + 8, 8);
+		position += 16;
+		if (entry.offset > mappingSize || entry.size > mappingSize - entry.offset) {
+			return false;
+		}
+		// find() relies on the order
+		if (!entries.empty() && !(entries.back().name < entry.name)) {
+			return false;
+		}
+		entries.push_back(std::move(entry));
+	}
+	return true;
+}
+
+bool writePack(const std::string& fileName, const std::vector<PackInput>& files) {
+	std::vector<const PackInput*> sorted;
+	for (const auto& file : files) {
+		sorted.push_back(&file);
+	}
+	std::sort(sorted.begin(), sorted.end(), [](const PackInput* a, const PackInput* b) {
+		return a->first < b->first;
+	});
+	for (size_t i = 1; i < sorted.size(); i++) {
+		if (sorted[i - 1]->first == sorted[i]->first) {
+			return false;
+		}
+	}
+
+	std::vector<char> out(MAGIC, MAGIC + 4);
+	writeUint(out, PackFile::VERSION, 4);
+	writeUint(out, sorted.size(), 4);
+	// filled in once the data is written
+	writeUint(out, 0, 8);
+
+	std::vector<PackFile::Entry> entries;
+	for (const auto* file : sorted) {
+		out.resize((out.size() + PACK_ALIGNMENT - 1) / PACK_ALIGNMENT * PACK_ALIGNMENT, 0);
+		entries.push_back({file->first, out.size(), file->second.size()});
+		out.insert(out.end(), file->second.begin(), file->second.end());
+	}
+
+	const uint64_t tableOffset = out.size();
+	for (size_t byte = 0; byte < 8; byte++) {
+		out[12 + byte] = static_cast<char>(static_cast<uint8_t>(tableOffset >> (8 * byte)));
+	}
+	for (const auto& entry : entries) {
+		if (entry.name.size() > UINT16_MAX) {
+			return false;
+		}
+		writeUint(out, entry.name.size(), 2);
+		out.insert(out.end(), entry.name.begin(), entry.name.end());
+		writeUint(out, entry.offset, 8);
+		writeUint(out, entry.size, 8);
+	}
+
+	std::ofstream packFile(fileName, std::ios::binary | std::ios::trunc);
+	packFile.write(out.data(), static_cast<std::streamsize>(out.size()));
+	return static_cast<bool>(packFile);
+}
+
+MemoryStreamBuffer::MemoryStreamBuffer(const char* data, const size_t size) {
+	// never written through, streambuf just doesn't have a const get area
+	char* begin = const_cast<char*>(data);
+	setg(begin, begin, begin + size);
+}
@@ -0,0 +1,196 @@
+#include <Schema.hpp>
+
+#include <cerrno>
+#include <climits>
+#include <cmath>
+#include <cstdlib>
+#include <sstream>
+
+namespace {
+
+bool equalsIgnoringCase(const std::string& text, const char* word) {
+	size_t i = 0;
+	for (; i < text.size() && word[i] != '\0'; i++) {
+		const char letter = text[i] >= 'A' && text[i] <= 'Z' ? static_cast<char>(text[i] - 'A' + 'a') : text[i];
+		if (letter != word[i]) {
+			return false;
+		}
+	}
+	return i == text.size() && word[i] == '\0';
+}
+
+// the same spellings yaml-cpp takes
+bool scalarToBool(const YAML::Node& node, bool& value) {
+	if (!node.IsScalar()) {
+		return false;
+	}
+	const std::string& text = node.Scalar();
+	for (const char* word : {"true", "yes", "on", "y"}) {
+		if (equalsIgnoringCase(text, word)) {
+			value = true;
+			return true;
+		}
+	}
+	for (const char* word : {"false", "no", "off", "n"}) {
+		if (equalsIgnoringCase(text, word)) {
+			value = false;
+			return true;
+		}
+	}
+	return false;
+}
+
+bool scalarToInt(const YAML::Node& node, int& value) {
+	if (!node.IsScalar() || node.Scalar().empty()) {
+		return false;
+	}
+	const std::string& text = node.Scalar();
+	char* end = nullptr;
+	errno = 0;
+	const long parsed = std::strtol(text.c_str(), &end, 10);
+	if (end != text.c_str() + text.size() || errno == ERANGE || parsed < INT_MIN || parsed > INT_MAX) {
+		return false;
+	}
+	value = static_cast<int>(parsed);
+	return true;
+}
+
+}
+
+std::string SchemaPath::toString() const {
+	if (parent == nullptr) {
+		return key;
+	}
+	return parent->toString() + (parent->parent == nullptr ? ": " : ".") + key;
+}
+
+void SchemaErrors::add(const SchemaPath& path, const std::string& problem) {
+	problems.push_back(path.toString() + " " + problem);
+}
+
+void SchemaErrors::addUnknownKey(const SchemaPath& path, const std::string& key) {
+	problems.push_back(path.toString() + " has an unknown key '" + key + "'");
+}
+
+void SchemaErrors::addOutOfRange(const SchemaPath& path, const double minimum, const double maximum) {
+	std::stringstream problem;
+	problem << "should be from " << minimum << " to " << maximum;
+	add(path, problem.str());
+}
+
+bool SchemaErrors::empty() const {
+	return problems.empty();
+}
+
+const std::vector<std::string>& SchemaErrors::get() const {
+	return problems;
+}
+
+bool scalarToFloat(const YAML::Node& node, float& value) {
+	if (!node.IsScalar() || node.Scalar().empty()) {
+		return false;
+	}
+	const std::string& text = node.Scalar();
+	char* end = nullptr;
+	errno = 0;
+	const float parsed = std::strtof(text.c_str(), &end);
+	// strtof takes nan & inf too, which would sail through every range check
+	if (end != text.c_str() + text.size() || errno == ERANGE || !std::isfinite(parsed)) {
+		return false;
+	}
+	value = parsed;
+	return true;
+}
+
+bool scalarToUnsigned(const YAML::Node& node, const unsigned long max, unsigned long& value) {
+	// strtoul would happily wrap negative numbers around
+	if (!node.IsScalar() || node.Scalar().empty() || node.Scalar()[0] < '0' || node.Scalar()[0] > '9') {
+		return false;
+	}
+	const std::string& text = node.Scalar();
+	char* end = nullptr;
+	errno = 0;
+	const unsigned long parsed = std::strtoul(text.c_str(), &end, 10);
+	if (end != text.c_str() + text.size() || errno == ERANGE || parsed > max) {
+		return false;
+	}
+	value = parsed;
+	return true;
+}
+
+bool parseValue(const YAML::Node& node, bool& value, const SchemaPath& path, SchemaErrors& errors) {
+	if (!scalarToBool(node, value)) {
+		errors.add(path, "should be true or false");
+		return false;
+	}
+	return true;
+}
+
+bool parseValue(const YAML::Node& node, int& value, const SchemaPath& path, SchemaErrors& errors) {
+	if (!scalarToInt(node, value)) {
+		errors.add(path, "should be a whole number");
+		return false;
+	}
+	return true;
+}
+
+bool parseValue(const YAML::Node& node, unsigned int& value, const SchemaPath& path, SchemaErrors& errors) {
+	unsigned long parsed = 0;
+	if (!scalarToUnsigned(node, UINT_MAX, parsed)) {
+		errors.add(path, "should be a positive whole number");
+		return false;
+	}
+	value = static_cast<unsigned int>(parsed);
+	return true;
+}
+
+bool parseValue(const YAML::Node& node, unsigned short& value, const SchemaPath& path, SchemaErrors& errors) {
+	unsigned long parsed = 0;
+	if (!scalarToUnsigned(node, USHRT_MAX, parsed)) {
+		errors.add(path, "should be a positive whole number up to " + std::to_string(USHRT_MAX));
+		return false;
+	}
+	value = static_cast<unsigned short>(parsed);
+	return true;
+}
+
+bool parseValue(const YAML::Node& node, float& value, const SchemaPath& path, SchemaErrors& errors) {
+	if (!scalarToFloat(node, value)) {
+		errors.add(path, "should be a number");
+		return false;
+	}
+	return true;
+}
+
+bool parseValue(const YAML::Node& node, std::string& value, const SchemaPath& path, SchemaErrors& errors) {
+	if (!node.IsScalar()) {
+		errors.add(path, "should be text");
+		return false;
+	}
+	value = node.Scalar();
+	return true;
+}
+
+bool parseValue(const YAML::Node& node, std::vector<unsigned int>& value, const SchemaPath& path, SchemaErrors& errors) {
+	if (!node.IsSequence()) {
+		errors.add(path, "should be a list of positive whole numbers");
+		return false;
+	}
+	std::vector<unsigned int> parsed;
+	parsed.reserve(node.size());
+	for (const auto& element : node) {
+		unsigned long number = 0;
+		if (!scalarToUnsigned(element, UINT_MAX, number)) {
+			errors.add(path, "should be a list of positive whole numbers");
+			return false;
+		}
+		parsed.push_back(static_cast<unsigned int>(number));
+	}
+	value.swap(parsed);
+	return true;
+}
+
+bool parseValue(const YAML::Node& node, YAML::Node& value, const SchemaPath&, SchemaErrors&) {
+	value.reset(node);
+	return true;
+}
@@ -0,0 +1,116 @@
+#include <Server.hpp>
+
+#include <algorithm>
+
+#include <easylogging++.h>
+
+namespace {
+
+// how many recent ticks can serve as a delta baseline
+const size_t SENT_HISTORY = 64;
+const size_t PENDING_INPUTS = 64;
+// inputs queued beyond this get skipped, to keep input latency bounded
+const uint32_t MAX_BUFFERED_INPUTS = 4;
+
+// tick & sequence comparisons that survive wrapping
+bool isNewer(const uint32_t a, const uint32_t b) {
+	return static_cast<int32_t>(a - b) > 0;
+}
+
+}
+
+GameServer::GameServer(const unsigned short port, const NetworkConditions& conditions, const uint32_t _snapshotInterval) :
+	channel(conditions, 1),
+	snapshotInterval(std::max(1u, _snapshotInterval)),
+	sent(SENT_HISTORY),
+	pending(PENDING_INPUTS, InputRecord{0, 0, 0}) {
+	listening = channel.bind(port);
+	if (listening) {
+		LOG(INFO) << "Server listening on port " << channel.getLocalPort();
+	} else {
+		LOG(ERROR) << "Server can't bind to port " << port;
+	}
+}
+
+bool GameServer::isListening() const {
+	return listening;
+}
+
+unsigned short GameServer::getPort() const {
+	return channel.getLocalPort();
+}
+
+void GameServer::receive() {
+	while (channel.receive(packet)) {
+		uint32_t sendTime;
+		uint32_t ack;
+		if (!decodeInputBatch(packet, sendTime, ack, received)) {
+			continue;
+		}
+		// packets can arrive out of order, only ever move forwards
+		if (isNewer(sendTime, echoTime)) {
+			echoTime = sendTime;
+			echoArrival = std::chrono::steady_clock::now();
+		}
+		if (ack != NO_TICK && (ackTick == NO_TICK || isNewer(ack, ackTick))) {
+			ackTick = ack;
+		}
+		for (const auto& input : received) {
+			if (isNewer(input.sequence, processedSequence)) {
+				pending[input.sequence % PENDING_INPUTS] = input;
+				if (isNewer(input.sequence, newestSequence)) {
+					newestSequence = input.sequence;
+				}
+			}
+		}
+	}
+}
+
+InputRecord GameServer::nextInput() {
+	if (isNewer(newestSequence, processedSequence + MAX_BUFFERED_INPUTS)) {
+		inputsLost += newestSequence - MAX_BUFFERED_INPUTS - processedSequence;
+		processedSequence = newestSequence - MAX_BUFFERED_INPUTS;
+	}
+	for (uint32_t sequence = processedSequence + 1; !isNewer(sequence, newestSequence); sequence++) {
+		const InputRecord& input = pending[sequence % PENDING_INPUTS];
+		if (input.sequence == sequence) {
+			// anything skipped over was lost in every packet that carried it
+			inputsLost += sequence - processedSequence - 1;
+			processedSequence = sequence;
+			lastInput = input;
+			repeatedTicks = 0;
+			return lastInput;
+		}
+	}
+	// nothing new, keep doing what the player was doing
+	repeatedTicks++;
+	return lastInput;
+}
+
+void GameServer::sendSnapshot(const WorldSnapshot& snapshot) {
+	sent[snapshot.tick % SENT_HISTORY] = snapshot;
+	if (!channel.hasPeer() || snapshot.tick % snapshotInterval != 0) {
+		channel.flush();
+		return;
+	}
+
+	const WorldSnapshot* baseline = nullptr;
+	if (ackTick != NO_TICK && snapshot.tick - ackTick < SENT_HISTORY && sent[ackTick % SENT_HISTORY].tick == ackTick) {
+		baseline = &sent[ackTick % SENT_HISTORY];
+	}
+	codec.encode(snapshot, baseline, payload);
+	const auto heldTime = static_cast<uint32_t>(
+		std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - echoArrival).count()
+	);
+	encodeSnapshotHeader(processedSequence, repeatedTicks, echoTime, heldTime, packet);
+	packet.insert(packet.end(), payload.begin(), payload.end());
+	channel.send(packet);
+}
+
+const ChannelStats& GameServer::getChannelStats() const {
+	return channel.getStats();
+}
+
+uint64_t GameServer::getInputsLost() const {
+	return inputsLost;
+}
@@ -0,0 +1,288 @@
+#include <Snapshot.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
+
+namespace {
+
+const uint8_t MAGIC[3] = {'J', 'S', 'N'};
+const uint8_t FLAG_DELTA = 1;
+// magic & version, flags, tick, base tick
+const size_t HEADER_SIZE = 4 + 1 + 4 + 4;
+const size_t ENTITY_SIZE = 4 + 4 + 4 + 2 + 2 + 2 + 2;
+// shorter zero runs aren't worth ending a literal run for
+const size_t MIN_ZERO_RUN = 3;
+
+void writeUint32(std::vector<uint8_t>& out, const uint32_t value) {
+	for (size_t byte = 0; byte < 4; byte++) {
+		out.push_back(static_cast<uint8_t>(value >> (8 * byte)));
+	}
+}
+
+uint32_t readUint32(const uint8_t* data) {
+	return static_cast<uint32_t>(data[0])
+		| static_cast<uint32_t>(data[1]) << 8
+		| static_cast<uint32_t>(data[2]) << 16
+		| static_cast<uint32_t>(data[3]) << 24;
+}
+
+void writeVarint(std::vector<uint8_t>& out, size_t value) {
+	while (value >= 0x80) {
+		out.push_back(static_cast<uint8_t>(value | 0x80));
+		value >>= 7;
+	}
+	out.push_back(static_cast<uint8_t>(value));
+}
+
+bool readVarint(const uint8_t*& data, const uint8_t* end, size_t& value) {
+	value = 0;
+	for (size_t shift = 0; shift < 64 && data < end; shift += 7) {
+		const uint8_t byte = *data++;
+		value |= static_cast<size_t>(byte & 0x7f) << shift;
+		if ((byte & 0x80) == 0) {
+			return true;
+		}
+	}
+	return false;
+}
+
+template <typename T>
+void packField(uint8_t*& out, const std::vector<EntityState>& entities, T EntityState::* field) {
+	using Unsigned = typename std::make_unsigned<T>::type;
+	for (size_t byte = 0; byte < sizeof(T); byte++) {
+		for (const auto& entity : entities) {
+			*out++ = static_cast<uint8_t>(static_cast<Unsigned>(entity.*field) >> (8 * byte));
+		}
+	}
+}
+
+template <typename T>
+void unpackField(const uint8_t*& in, std::vector<EntityState>& entities, T EntityState::* field) {
+	using Unsigned = typename std::make_unsigned<T>::type;
+	for (auto& entity : entities) {
+		entity.*field = 0;
+	}
+	for (size_t byte = 0; byte < sizeof(T); byte++) {
+		for (auto& entity : entities) {
+			const auto bits = static_cast<Unsigned>(static_cast<Unsigned>(*in++) << (8 * byte));
+			entity.*field = static_cast<T>(static_cast<Unsigned>(entity.*field) | bits);
+		}
+	}
+}
+
+}
+
+int32_t quantizePosition(const float position) {
+	return static_cast<int32_t>(std::lround(position * 16.0f));
+}
+
+float dequantizePosition(const int32_t position) {
+	return static_cast<float>(position) / 16.0f;
+}
+
+uint16_t quantizeRotation(const float degrees) {
+	float turns = degrees / 360.0f;
+	turns -= std::floor(turns);
+	return static_cast<uint16_t>(std::lround(turns * 65536.0f) & 0xffff);
+}
+
+float dequantizeRotation(const uint16_t rotation) {
+	return static_cast<float>(rotation) * 360.0f / 65536.0f;
+}
+
+int16_t quantizeVelocity(const float velocity) {
+	const long quantized = std::lround(velocity * 128.0f);
+	return static_cast<int16_t>(std::min(32767L, std::max(-32768L, quantized)));
+}
+
+float dequantizeVelocity(const int16_t velocity) {
+	return static_cast<float>(velocity) / 128.0f;
+}
+
+uint16_t quantizeSpeed(const float speed) {
+	const long quantized = std::lround(speed * 16.0f);
+	return static_cast<uint16_t>(std::min(65535L, std::max(0L, quantized)));
+}
+
+float dequantizeSpeed(const uint16_t speed) {
+	return static_cast<float>(speed) / 16.0f;
+}
+
+void SnapshotCodec::encode(const WorldSnapshot& snapshot, const WorldSnapshot* baseline, std::vector<uint8_t>& out) {
+	const bool delta = baseline != nullptr && baseline->entities.size() == snapshot.entities.size();
+
+	out.clear();
+	out.push_back(MAGIC[0]);
+	out.push_back(MAGIC[1]);
+	out.push_back(MAGIC[2]);
+	out.push_back(SNAPSHOT_VERSION);
+	out.push_back(delta ? FLAG_DELTA : 0);
+	writeUint32(out, snapshot.tick);
+	writeUint32(out, delta ? baseline->tick : 0);
+	writeVarint(out, snapshot.entities.size());
+
+	pack(snapshot.entities, planes);
+	if (delta) {
+		pack(baseline->entities, basePlanes);
+		for (size_t i = 0; i < planes.size(); i++) {
+			planes[i] ^= basePlanes[i];
+		}
+	}
+
+	// alternate runs of zeros and literal bytes
+	size_t i = 0;
+	while (i < planes.size()) {
+		const size_t zeroStart = i;
+		while (i < planes.size() && planes[i] == 0) {
+			i++;
+		}
+		const size_t literalStart = i;
+		size_t zeros = 0;
+		while (i < planes.size() && zeros < MIN_ZERO_RUN) {
+			zeros = planes[i] == 0 ? zeros + 1 : 0;
+			i++;
+		}
+		if (zeros == MIN_ZERO_RUN) {
+			// give the zeros back to the next run
+			i -= zeros;
+		}
+		writeVarint(out, literalStart - zeroStart);
+		writeVarint(out, i - literalStart);
+		out.insert(out.end(), planes.begin() + static_cast<std::ptrdiff_t>(literalStart), planes.begin() + static_cast<std::ptrdiff_t>(i));
+	}
+}
+
+bool SnapshotCodec::decode(const uint8_t* data, const size_t size, const WorldSnapshot* baseline, WorldSnapshot& out) {
+	uint32_t tick;
+	uint32_t baseTick;
+	if (!peekTicks(data, size, tick, baseTick)) {
+		return false;
+	}
+	const bool delta = (data[4] & FLAG_DELTA) != 0;
+	const uint8_t* in = data + HEADER_SIZE;
+	const uint8_t* end = data + size;
+
+	size_t count;
+	if (!readVarint(in, end, count)) {
+		return false;
+	}
+	// zero runs let a few bytes describe any size, so only a fixed cap keeps a bad count from allocating gigabytes
+	if (count > SNAPSHOT_MAX_ENTITIES) {
+		return false;
+	}
+	if (delta && (baseline == nullptr || baseline->tick != baseTick || baseline->entities.size() != count)) {
+		return false;
+	}
+
+	planes.assign(count * ENTITY_SIZE, 0);
+	size_t position = 0;
+	while (position < planes.size()) {
+		size_t zeros;
+		size_t literals;
+		if (!readVarint(in, end, zeros) || !readVarint(in, end, literals)) {
+			return false;
+		}
+		if (zeros > planes.size() - position || literals > planes.size() - position - zeros
+			|| literals > static_cast<size_t>(end - in)) {
+			return false;
+		}
+		position += zeros;
+		std::copy(in, in + literals, planes.begin() + static_cast<std::ptrdiff_t>(position));
+		in += literals;
+		position += literals;
+	}
+
+	if (delta) {
+		pack(baseline->entities, basePlanes);
+		for (size_t i = 0; i < planes.size(); i++) {
+			planes[i] ^= basePlanes[i];
+		}
+	}
+
+	out.tick = tick;
+	out.entities.resize(count);
+	unpack(planes, out.entities);
+	return true;
+}
+
+bool SnapshotCodec::peekTicks(const uint8_t* data, const size_t size, uint32_t& tick, uint32_t& baseTick) {
+	if (size < HEADER_SIZE || !std::equal(MAGIC, MAGIC + 3, data) || data[3] != SNAPSHOT_VERSION) {
+		return false;
+	}
+	tick = readUint32(data + 5);
+	baseTick = readUint32(data + 9);
+	return true;
+}
+
+void SnapshotCodec::pack(const std::vector<EntityState>& entities, std::vector<uint8_t>& planes) {
+	planes.resize(entities.size() * ENTITY_SIZE);
+	uint8_t* out = planes.data();
+	packField(out, entities, &EntityState::id);
+	packField(out, entities, &EntityState::x);
+	packField(out, entities, &EntityState::y);
+	packField(out, entities, &EntityState::rotation);
+	packField(out, entities, &EntityState::velocityX);
+	packField(out, entities, &EntityState::velocityY);
+	packField(out, entities, &EntityState::speed);
+}
+
+void SnapshotCodec::unpack(const std::vector<uint8_t>& planes, std::vector<EntityState>& entities) {
+	const uint8_t* in = planes.data();
+	unpackField(in, entities, &EntityState::id);
+	unpackField(in, entities, &EntityState::x);
+	unpackField(in, entities, &EntityState::y);
+	unpackField(in, entities, &EntityState::rotation);
+	unpackField(in, entities, &EntityState::velocityX);
+	unpackField(in, entities, &EntityState::velocityY);
+	unpackField(in, entities, &EntityState::speed);
+}
+
+SnapshotHistory::SnapshotHistory(const size_t _capacity) :
+	ring(std::max<size_t>(1, _capacity)),
+	capacity(std::max<size_t>(1, _capacity)) {
+}
+
+void SnapshotHistory::capture(const WorldSnapshot& snapshot) {
+	if (hasLatest) {
+		// store how to get from this tick back to the one before it
+		codec.encode(latest, &snapshot, ring[head]);
+		head = (head + 1) % capacity;
+		count = std::min(count + 1, capacity);
+	}
+	latest = snapshot;
+	hasLatest = true;
+}
+
+bool SnapshotHistory::rewind(WorldSnapshot& snapshot) {
+	if (count == 0) {
+		return false;
+	}
+	const size_t entry = (head + capacity - 1) % capacity;
+	if (!codec.decode(ring[entry].data(), ring[entry].size(), &latest, previous)) {
+		// shouldn't happen, but don't keep trying to decode a bad entry
+		count = 0;
+		return false;
+	}
+	head = entry;
+	count--;
+	std::swap(latest, previous);
+	snapshot = latest;
+	return true;
+}
+
+size_t SnapshotHistory::size() const {
+	return count;
+}
+
+size_t SnapshotHistory::getCapacity() const {
+	return capacity;
+}
+
+size_t SnapshotHistory::bytesUsed() const {
+	size_t bytes = 0;
+	for (size_t i = 0; i < count; i++) {
+		bytes += ring[(head + capacity - 1 - i) % capacity].size();
+	}
+	return bytes;
+}
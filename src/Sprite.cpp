@@ -1,15 +1,52 @@
 #include <Sprite.hpp>
 
+template <>
+struct Schema<SpriteDefinition> {
+	static constexpr auto fields() {
+		return std::make_tuple(
+			field("type", &SpriteDefinition::type),
+			field("size", &SpriteDefinition::size, 0.0),
+			field("rotation", &SpriteDefinition::rotation),
+			field("behavior", &SpriteDefinition::behavior),
+			field("vertices", &SpriteDefinition::vertices),
+			field("colors", &SpriteDefinition::colors),
+			field("indexes", &SpriteDefinition::indexes)
+		);
+	}
+};
+
+bool parseSpriteDefinition(
+	const YAML::Node& node, SpriteDefinition& definition, const SchemaPath& path, SchemaErrors& errors
+) {
+	return parseObject(node, definition, path, errors);
+}
+
 Sprite::Sprite(const std::string& _fileName) {
-	loadFromYAML(_fileName);
+	loaded = loadFromYAML(_fileName);
+}
+
+Sprite::Sprite(const AssetSource& source, const std::string& name) {
+	loaded = loadFromAsset(source, name);
+}
+
+Sprite::Sprite(const std::string& name, const YAML::Node& dataFile) {
+	ScopedAllocationTag assetsTag(AllocationTag::Assets);
+	fileName = name;
+	try {
+		loaded = loadFromNode(dataFile);
+	} catch (YAML::Exception& e) {
+		LOG(ERROR) << "YAML Exception: " << e.what();
+	}
 }
 
 Sprite::Sprite(const sf::Texture& _texture) {
 	setTexture(_texture);
+	loaded = true;
 }
 
 Sprite::Sprite(const sf::Image& _image) {
 	setTexture(_image);
+	loaded = true;
 }
 
 Sprite::~Sprite() = default;
@@ -19,6 +56,18 @@ void Sprite::setVelocityDir(const float& x, const float& y) {
 	velocityDir.y = y;
 }
 
+const sf::Vector2f& Sprite::getVelocityDir() const {
+	return velocityDir;
+}
+
+void Sprite::setSpeed(const float _speed) {
+	speed = _speed;
+}
+
+float Sprite::getSpeed() const {
+	return speed;
+}
+
 void Sprite::update(const std::chrono::nanoseconds& elapsed) {
 	move(velocityDir * (speed * static_cast<float>(elapsed.count()) / (1s / 1ns)));
 }
@@ -31,88 +80,148 @@ void Sprite::draw(sf::RenderTarget& target, sf::RenderStates states) const {
 	target.draw(vertices, states);
 }
 
+void Sprite::drawWithTransform(sf::RenderTarget& target, const sf::Transform& transform) const {
+	sf::RenderStates states(transform);
+	if (texture) {
+		states.texture = texture.get();
+	}
+	target.draw(vertices, states);
+}
+
+
+const std::string& Sprite::getBehavior() const {
+	return behavior;
+}
+
+bool Sprite::isLoaded() const {
+	return loaded;
+}
+
+size_t Sprite::getMemoryUsage() const {
+	return sizeof(Sprite) + vertices.getVertexCount() * sizeof(sf::Vertex) + fileName.capacity() + behavior.capacity();
+}
 
 bool Sprite::loadFromYAML(const std::string& _fileName) {
+	ScopedAllocationTag assetsTag(AllocationTag::Assets);
 	fileName = _fileName;
 	try {
 		LOG(INFO) << "Loading '" << fileName << "'";
-		YAML::Node dataFile = YAML::LoadFile(fileName);
-
-		const std::string& type = dataFile["type"].as<std::string>("");
-
-		LOG(INFO) << "Entity Type: " << type;
-		if (type == "sprite") {
-			size = dataFile["size"].as<float>(DEFAULT_SPRITE_SIZE);
-			LOG(INFO) << "Initial size: " << size;
-
-			auto rotation = dataFile["rotation"].as<float>(0.0f);
-			rotate(rotation);
-			LOG(INFO) << "Initial rotation: " << rotation;
-
-			vertices.setPrimitiveType(sf::TriangleStrip);
-
-			// get all the vertices
-			std::vector<sf::Vertex> vertexList;
-			YAML::Node vertexListNode = dataFile["vertices"];
-			if (vertexListNode && (vertexListNode.Type() == YAML::NodeType::Sequence)) {
-				LOG(INFO) << "Vertex list size: " << vertexListNode.size();
-				for (
-					auto&& vertexIter = vertexListNode.begin(); vertexIter != vertexListNode.end(); vertexIter++
-					) {
-					const YAML::Node& node = vertexIter.operator*();
-					const sf::Vertex& vertex = nodeToVertex(node, size);
-					vertexList.push_back(vertex);
-					LOG(DEBUG) << "Vertex found: " << YAML::Dump(node) << " = " << vertexToString(vertex);
+		return loadFromNode(YAML::LoadFile(fileName));
+	} catch (YAML::Exception& e) {
+		LOG(ERROR) << "YAML Exception: " << e.what();
+		return false;
+	}
+}
+
+bool Sprite::loadFromAsset(const AssetSource& source, const std::string& name) {
+	ScopedAllocationTag assetsTag(AllocationTag::Assets);
+	fileName = name;
+	try {
+		LOG(INFO) << "Loading '" << fileName << "' from " << source.getLocation();
+		return loadFromNode(source.loadYAML(fileName));
+	} catch (YAML::Exception& e) {
+		LOG(ERROR) << "YAML Exception: " << e.what();
+		return false;
+	}
+}
+
+bool Sprite::loadFromNode(const YAML::Node& dataFile) {
+	// the vertex & color lists are only needed while loading
+	ArenaScope scratch(frameArena());
+
+	SpriteDefinition definition;
+	definition.size = DEFAULT_SPRITE_SIZE;
+	SchemaErrors errors;
+	if (!parseSpriteDefinition(dataFile, definition, SchemaPath{nullptr, fileName.c_str()}, errors)) {
+		for (const auto& problem : errors.get()) {
+			LOG(WARNING) << problem;
+		}
+	}
+
+	LOG(INFO) << "Entity Type: " << definition.type;
+	if (definition.type == "sprite") {
+		size = definition.size;
+		LOG(INFO) << "Initial size: " << size;
+
+		rotate(definition.rotation);
+		LOG(INFO) << "Initial rotation: " << definition.rotation;
+
+		behavior.swap(definition.behavior);
+		if (!behavior.empty()) {
+			LOG(INFO) << "Behavior: " << behavior;
+		}
+
+		vertices.setPrimitiveType(sf::TriangleStrip);
+
+		// get all the vertices
+		ArenaVector<sf::Vertex> vertexList{ArenaAllocator<sf::Vertex>(frameArena())};
+		const YAML::Node& vertexListNode = definition.vertices;
+		if (vertexListNode && (vertexListNode.Type() == YAML::NodeType::Sequence)) {
+			LOG(INFO) << "Vertex list size: " << vertexListNode.size();
+			vertexList.reserve(vertexListNode.size());
+			for (const auto& node : vertexListNode) {
+				sf::Vertex vertex;
+				if (!nodeToVertex(node, size, vertex)) {
+					LOG(ERROR) << "Vertex " << vertexList.size() + 1 << " isn't an [x, y] pair of numbers";
+					return false;
 				}
+				vertexList.push_back(vertex);
+				LOG(DEBUG) << "Vertex found: " << YAML::Dump(node) << " = " << vertexToString(vertex);
 			}
+		}
 
-			// get all the colors
-			std::vector<sf::Color> colorList;
-			YAML::Node colorListNode = dataFile["colors"];
-			if (colorListNode && (colorListNode.Type() == YAML::NodeType::Sequence)) {
-				LOG(INFO) << "Color list size: " << colorListNode.size();
-				for (auto&& colorIter = colorListNode.begin(); colorIter != colorListNode.end(); colorIter++) {
-					const YAML::Node& node = colorIter.operator*();
-					const sf::Color& color = nodeToColor(node);
-					colorList.push_back(color);
-					LOG(DEBUG) << "Color found: " << YAML::Dump(node) << " = " << colorToString(color);
+		// get all the colors
+		ArenaVector<sf::Color> colorList{ArenaAllocator<sf::Color>(frameArena())};
+		const YAML::Node& colorListNode = definition.colors;
+		if (colorListNode && (colorListNode.Type() == YAML::NodeType::Sequence)) {
+			LOG(INFO) << "Color list size: " << colorListNode.size();
+			colorList.reserve(colorListNode.size());
+			for (const auto& node : colorListNode) {
+				sf::Color color;
+				if (!nodeToColor(node, color)) {
+					LOG(ERROR) << "Color " << colorList.size() + 1 << " isn't an [r, g, b, a] list of numbers";
+					return false;
 				}
+				colorList.push_back(color);
+				LOG(DEBUG) << "Color found: " << YAML::Dump(node) << " = " << colorToString(color);
 			}
+		}
 
-			// get the indexes into the vertex and color lists/
-			YAML::Node indexList = dataFile["indexes"];
-			if (indexList && (indexList.Type() == YAML::NodeType::Sequence)) {
-				LOG(INFO) << "Index list size: " << indexList.size();
-				sf::Color color;
-				bool foundColor = false;
-				for (auto&& indexIter = indexList.begin(); indexIter != indexList.end(); indexIter++) {
-					if (indexIter->Type() == YAML::NodeType::Map) {
-						auto colorIndex = indexIter->operator[]("color").as<uint32_t>(0);
-						color = colorList[colorIndex - 1];
-						LOG(INFO) << "Found color index: " << colorIndex << " = " << colorToString(color);
-						foundColor = true;
-						continue;
+		// get the indexes into the vertex and color lists/
+		const YAML::Node& indexList = definition.indexes;
+		if (indexList && (indexList.Type() == YAML::NodeType::Sequence)) {
+			LOG(INFO) << "Index list size: " << indexList.size();
+			sf::Color color;
+			bool foundColor = false;
+			for (auto&& indexIter = indexList.begin(); indexIter != indexList.end(); indexIter++) {
+				if (indexIter->Type() == YAML::NodeType::Map) {
+					unsigned long colorIndex = 0;
+					if (!scalarToUnsigned(indexIter->operator[]("color"), colorList.size(), colorIndex) || colorIndex == 0) {
+						LOG(ERROR) << "Color index should be from 1 to " << colorList.size();
+						return false;
 					}
-					if (indexIter->Type() == YAML::NodeType::Sequence) {
-						for (auto indexIter2 = indexIter->begin(); indexIter2 != indexIter->end(); indexIter2++) {
-							auto vertexIndex = indexIter2->as<uint32_t>(0);
-							if (vertexIndex == 0) {
-								color = sf::Color::White;
-							}
-							sf::Vertex vertex = vertexList[vertexIndex - 1];
-							LOG(INFO) << "Found vertex index: " << vertexIndex << " = " << vertexToString(vertex);
-							if (foundColor) {
-								vertex.color = color;
-							}
-							vertices.append(vertex);
+					color = colorList[colorIndex - 1];
+					LOG(INFO) << "Found color index: " << colorIndex << " = " << colorToString(color);
+					foundColor = true;
+					continue;
+				}
+				if (indexIter->Type() == YAML::NodeType::Sequence) {
+					for (auto indexIter2 = indexIter->begin(); indexIter2 != indexIter->end(); indexIter2++) {
+						unsigned long vertexIndex = 0;
+						if (!scalarToUnsigned(*indexIter2, vertexList.size(), vertexIndex) || vertexIndex == 0) {
+							LOG(ERROR) << "Vertex index should be from 1 to " << vertexList.size();
+							return false;
+						}
+						sf::Vertex vertex = vertexList[vertexIndex - 1];
+						LOG(INFO) << "Found vertex index: " << vertexIndex << " = " << vertexToString(vertex);
+						if (foundColor) {
+							vertex.color = color;
 						}
+						vertices.append(vertex);
 					}
 				}
 			}
 		}
-	} catch (YAML::Exception& e) {
-		LOG(ERROR) << "YAML Exception: " << e.what();
-		return false;
 	}
 	return true;
 }
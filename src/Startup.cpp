@@ -0,0 +1,189 @@
+#include <Startup.hpp>
+
+#include <algorithm>
+#include <exception>
+#include <thread>
+
+#include <easylogging++.h>
+
+using namespace std::chrono_literals;
+
+namespace {
+
+float toMilliseconds(const std::chrono::nanoseconds& duration) {
+	return static_cast<float>(duration.count()) / (1ms / 1ns);
+}
+
+}
+
+StartupGraph::StartupGraph(const clock::time_point _origin) :
+	origin(_origin) {
+}
+
+size_t StartupGraph::addStage(
+	const std::string& name,
+	const Where where,
+	const std::vector<size_t>& dependencies,
+	std::function<void()> work
+) {
+	Stage stage;
+	stage.name = name;
+	stage.where = where;
+	// only earlier stages can be depended on, so there can't be a cycle
+	for (const size_t dependency : dependencies) {
+		if (dependency < stages.size()) {
+			stage.dependencies.push_back(dependency);
+		} else {
+			LOG(ERROR) << "Startup stage '" << name << "' can't depend on unknown stage " << dependency;
+		}
+	}
+	stage.work = std::move(work);
+	stages.push_back(std::move(stage));
+	return stages.size() - 1;
+}
+
+bool StartupGraph::run(const ThreadSettings& workerSettings, const unsigned int maxWorkers) {
+	const auto workerStages = static_cast<size_t>(std::count_if(stages.begin(), stages.end(), [](const Stage& stage) {
+		return stage.where == Where::Worker;
+	}));
+	const size_t workerCount = std::min<size_t>(std::max(1u, maxWorkers), workerStages);
+	std::vector<std::thread> workers;
+
+	std::unique_lock<std::mutex> lock(mutex);
+	while (!allDone()) {
+		if (workers.empty() && workerCount > 0 && hasReadyStage(Where::Worker)) {
+			for (size_t i = 0; i < workerCount; i++) {
+				workers.emplace_back(&StartupGraph::workerFunc, this, std::cref(workerSettings));
+			}
+		}
+		const size_t id = takeReadyStage(Where::MainThread);
+		if (id != NONE) {
+			runStage(id, lock);
+			continue;
+		}
+		stageDone.wait(lock);
+	}
+	lock.unlock();
+
+	for (auto& worker : workers) {
+		worker.join();
+	}
+
+	return std::none_of(stages.begin(), stages.end(), [](const Stage& stage) {
+		return stage.failed;
+	});
+}
+
+void StartupGraph::logTimings() const {
+	LOG(INFO) << "Startup stages:";
+	for (const auto& stage : stages) {
+		if (stage.failed && stage.endTime == clock::time_point()) {
+			LOG(INFO) << "\t" << stage.name << ": skipped";
+			continue;
+		}
+		LOG(INFO) << "\t" << stage.name << ": "
+			<< toMilliseconds(stage.startTime - origin) << "ms - "
+			<< toMilliseconds(stage.endTime - origin) << "ms ("
+			<< toMilliseconds(stage.endTime - stage.startTime) << "ms) on "
+			<< (stage.where == Where::MainThread ? "main thread" : "worker")
+			<< (stage.failed ? ", failed" : "");
+	}
+
+	// walk back from the last stage to finish, through whichever dependency held it up
+	size_t last = NONE;
+	for (size_t id = 0; id < stages.size(); id++) {
+		if (last == NONE || stages[id].endTime > stages[last].endTime) {
+			last = id;
+		}
+	}
+	std::string path;
+	while (last != NONE) {
+		path = path.empty() ? stages[last].name : stages[last].name + " > " + path;
+		size_t blocker = NONE;
+		for (const size_t dependency : stages[last].dependencies) {
+			if (blocker == NONE || stages[dependency].endTime > stages[blocker].endTime) {
+				blocker = dependency;
+			}
+		}
+		last = blocker;
+	}
+	LOG(INFO) << "Startup critical path: " << path;
+}
+
+size_t StartupGraph::takeReadyStage(const Where where) {
+	for (size_t id = 0; id < stages.size(); id++) {
+		Stage& stage = stages[id];
+		if (stage.started) {
+			continue;
+		}
+		bool ready = true;
+		for (const size_t dependency : stage.dependencies) {
+			if (stages[dependency].failed) {
+				// nothing that needed a failed stage can run, and neither can anything after it
+				stage.started = true;
+				stage.done = true;
+				stage.failed = true;
+				LOG(ERROR) << "Skipping startup stage '" << stage.name << "', '" << stages[dependency].name << "' failed";
+				stageDone.notify_all();
+				ready = false;
+				break;
+			}
+			ready = ready && stages[dependency].done;
+		}
+		if (ready && stage.where == where) {
+			stage.started = true;
+			return id;
+		}
+	}
+	return NONE;
+}
+
+bool StartupGraph::hasReadyStage(const Where where) const {
+	return std::any_of(stages.begin(), stages.end(), [this, where](const Stage& stage) {
+		return !stage.started && stage.where == where
+			&& std::all_of(stage.dependencies.begin(), stage.dependencies.end(), [this](const size_t dependency) {
+				return stages[dependency].done;
+			});
+	});
+}
+
+bool StartupGraph::allDone() const {
+	return std::all_of(stages.begin(), stages.end(), [](const Stage& stage) {
+		return stage.done;
+	});
+}
+
+void StartupGraph::runStage(const size_t id, std::unique_lock<std::mutex>& lock) {
+	Stage& stage = stages[id];
+	stage.startTime = clock::now();
+	lock.unlock();
+
+	bool failed = false;
+	try {
+		stage.work();
+	} catch (const std::exception& e) {
+		LOG(ERROR) << "Startup stage '" << stage.name << "' failed: " << e.what();
+		failed = true;
+	}
+
+	lock.lock();
+	stage.endTime = clock::now();
+	stage.failed = failed;
+	stage.done = true;
+	stageDone.notify_all();
+}
+
+void StartupGraph::workerFunc(const ThreadSettings& settings) {
+	el::Helpers::setThreadName(settings.name);
+	LOG(INFO) << "Startup worker: " << applyThreadSettings(settings);
+
+	std::unique_lock<std::mutex> lock(mutex);
+	while (!allDone()) {
+		const size_t id = takeReadyStage(Where::Worker);
+		if (id != NONE) {
+			runStage(id, lock);
+			continue;
+		}
+		stageDone.wait(lock);
+	}
+}
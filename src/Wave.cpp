@@ -0,0 +1,44 @@
+#include <Wave.hpp>
+
+#include <algorithm>
+
+#include <easylogging++.h>
+
+bool nodeToWaves(const YAML::Node& node, std::vector<Wave>& waves) {
+	YAML::Node wavesNode = node["waves"];
+	if (!wavesNode || wavesNode.Type() != YAML::NodeType::Sequence) {
+		LOG(ERROR) << "Waves must be a list under 'waves'";
+		return false;
+	}
+	bool ok = true;
+	for (auto&& waveIter = wavesNode.begin(); waveIter != wavesNode.end(); waveIter++) {
+		Wave wave;
+		wave.name = waveIter->operator[]("name").as<std::string>("wave " + std::to_string(waves.size() + 1));
+		wave.duration = waveIter->operator[]("duration").as<float>(wave.duration);
+
+		YAML::Node enemiesNode = waveIter->operator[]("enemies");
+		if (enemiesNode && enemiesNode.Type() == YAML::NodeType::Sequence) {
+			for (auto&& enemyIter = enemiesNode.begin(); enemyIter != enemiesNode.end(); enemyIter++) {
+				WaveSpawn spawn;
+				spawn.sprite = enemyIter->operator[]("sprite").as<std::string>("");
+				spawn.count = enemyIter->operator[]("count").as<uint32_t>(spawn.count);
+				if (spawn.sprite.empty() || spawn.count == 0) {
+					LOG(ERROR) << "Wave '" << wave.name << "' has an enemy without a sprite or count, skipping it";
+					ok = false;
+					continue;
+				}
+				wave.spawns.push_back(spawn);
+				if (std::find(wave.assets.begin(), wave.assets.end(), spawn.sprite) == wave.assets.end()) {
+					wave.assets.push_back(spawn.sprite);
+				}
+			}
+		}
+		if (wave.spawns.empty() || wave.duration <= 0.0f) {
+			LOG(ERROR) << "Wave '" << wave.name << "' needs enemies and a positive duration, skipping it";
+			ok = false;
+			continue;
+		}
+		waves.push_back(wave);
+	}
+	return ok;
+}
@@ -0,0 +1,194 @@
+#include <memory.hpp>
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+struct ThreadAllocationState {
+	AllocationTag tag;
+	uint64_t allocations;
+	uint64_t bytes;
+};
+
+// plain data, so it's safe to touch from inside operator new on any thread
+thread_local ThreadAllocationState threadState = {AllocationTag::General, 0, 0};
+
+#ifdef JAGE_TRACK_ALLOCATIONS
+
+struct TagCounters {
+	std::atomic<uint64_t> allocations;
+	std::atomic<uint64_t> frees;
+	std::atomic<int64_t> liveBytes;
+	std::atomic<int64_t> peakBytes;
+};
+
+// zero-initialized before any dynamic initialization, so usable from the first allocation
+TagCounters tagCounters[ALLOCATION_TAG_COUNT];
+
+// stored in front of every block so delete knows the size and who to charge
+struct alignas(std::max_align_t) AllocationHeader {
+	size_t size;
+	AllocationTag tag;
+};
+
+void* trackedAllocate(const size_t size) noexcept {
+	void* block = std::malloc(sizeof(AllocationHeader) + size);
+	if (block == nullptr) {
+		return nullptr;
+	}
+	auto header = static_cast<AllocationHeader*>(block);
+	header->size = size;
+	header->tag = threadState.tag;
+
+	threadState.allocations++;
+	threadState.bytes += size;
+
+	TagCounters& counters = tagCounters[static_cast<size_t>(header->tag)];
+	counters.allocations.fetch_add(1, std::memory_order_relaxed);
+	const auto live = counters.liveBytes.fetch_add(static_cast<int64_t>(size), std::memory_order_relaxed)
+		+ static_cast<int64_t>(size);
+	auto peak = counters.peakBytes.load(std::memory_order_relaxed);
+	while (live > peak && !counters.peakBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+	}
+	return header + 1;
+}
+
+void* trackedAllocateOrThrow(const size_t size) {
+	void* memory;
+	while ((memory = trackedAllocate(size)) == nullptr) {
+		std::new_handler handler = std::get_new_handler();
+		if (handler == nullptr) {
+			throw std::bad_alloc();
+		}
+		handler();
+	}
+	return memory;
+}
+
+void trackedFree(void* memory) noexcept {
+	if (memory == nullptr) {
+		return;
+	}
+	auto header = static_cast<AllocationHeader*>(memory) - 1;
+	TagCounters& counters = tagCounters[static_cast<size_t>(header->tag)];
+	counters.frees.fetch_add(1, std::memory_order_relaxed);
+	counters.liveBytes.fetch_sub(static_cast<int64_t>(header->size), std::memory_order_relaxed);
+	std::free(header);
+}
+
+#endif
+
+}
+
+const char* allocationTagToString(const AllocationTag tag) {
+	switch (tag) {
+	case AllocationTag::General:
+		return "general";
+	case AllocationTag::Assets:
+		return "assets";
+	case AllocationTag::Entities:
+		return "entities";
+	case AllocationTag::Render:
+		return "render";
+	case AllocationTag::Logging:
+		return "logging";
+	case AllocationTag::Count:
+	default:
+		return "unknown";
+	}
+}
+
+bool allocationTrackingEnabled() {
+	#ifdef JAGE_TRACK_ALLOCATIONS
+	return true;
+	#else
+	return false;
+	#endif
+}
+
+AllocationCounters allocationCounters(const AllocationTag tag) {
+	AllocationCounters ret;
+	#ifdef JAGE_TRACK_ALLOCATIONS
+	const TagCounters& counters = tagCounters[static_cast<size_t>(tag)];
+	ret.allocations = counters.allocations.load(std::memory_order_relaxed);
+	ret.frees = counters.frees.load(std::memory_order_relaxed);
+	ret.liveBytes = counters.liveBytes.load(std::memory_order_relaxed);
+	ret.peakBytes = counters.peakBytes.load(std::memory_order_relaxed);
+	#else
+	(void) tag;
+	#endif
+	return ret;
+}
+
+uint64_t threadAllocationCount() {
+	return threadState.allocations;
+}
+
+uint64_t threadAllocationBytes() {
+	return threadState.bytes;
+}
+
+AllocationTag threadAllocationTag() {
+	return threadState.tag;
+}
+
+void setThreadAllocationTag(const AllocationTag tag) {
+	threadState.tag = tag;
+}
+
+ScopedAllocationTag::ScopedAllocationTag(const AllocationTag tag) :
+	previousTag(threadState.tag) {
+	threadState.tag = tag;
+}
+
+ScopedAllocationTag::~ScopedAllocationTag() {
+	threadState.tag = previousTag;
+}
+
+#ifdef JAGE_TRACK_ALLOCATIONS
+
+// replace the global allocation functions, every other form forwards to these
+
+void* operator new(size_t size) {
+	return trackedAllocateOrThrow(size);
+}
+
+void* operator new[](size_t size) {
+	return trackedAllocateOrThrow(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+	return trackedAllocate(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+	return trackedAllocate(size);
+}
+
+void operator delete(void* memory) noexcept {
+	trackedFree(memory);
+}
+
+void operator delete[](void* memory) noexcept {
+	trackedFree(memory);
+}
+
+void operator delete(void* memory, const std::nothrow_t&) noexcept {
+	trackedFree(memory);
+}
+
+void operator delete[](void* memory, const std::nothrow_t&) noexcept {
+	trackedFree(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept {
+	trackedFree(memory);
+}
+
+void operator delete[](void* memory, size_t) noexcept {
+	trackedFree(memory);
+}
+
+#endif
@@ -0,0 +1,226 @@
+#include <threading.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <sstream>
+#include <thread>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+namespace {
+
+std::string policyToString(const ThreadSettings::Policy policy) {
+	switch (policy) {
+	case ThreadSettings::Policy::Nice:
+		return "nice";
+	case ThreadSettings::Policy::Fifo:
+		return "fifo";
+	case ThreadSettings::Policy::Default:
+	default:
+		return "default";
+	}
+}
+
+#ifdef __linux__
+std::vector<unsigned int> cpuSetToCores(const cpu_set_t& set) {
+	std::vector<unsigned int> cores;
+	for (unsigned int core = 0; core < CPU_SETSIZE; core++) {
+		if (CPU_ISSET(core, &set)) {
+			cores.push_back(core);
+		}
+	}
+	return cores;
+}
+#endif
+
+}
+
+bool parsePolicy(const YAML::Node& node, ThreadSettings::Policy& policy, const SchemaPath& path, SchemaErrors& errors) {
+	if (node.IsScalar()) {
+		const std::string& text = node.Scalar();
+		if (text == "default") {
+			policy = ThreadSettings::Policy::Default;
+			return true;
+		} else if (text == "nice") {
+			policy = ThreadSettings::Policy::Nice;
+			return true;
+		} else if (text == "fifo") {
+			policy = ThreadSettings::Policy::Fifo;
+			return true;
+		}
+	}
+	errors.add(path, "should be default, nice or fifo");
+	return false;
+}
+
+std::string threadSettingsToString(const ThreadSettings& settings) {
+	std::stringstream ret;
+	ret << "name: " << settings.name
+		<< ", cores: " << (settings.cores.empty() ? "any" : coresToString(settings.cores))
+		<< ", policy: " << policyToString(settings.policy);
+	if (settings.policy != ThreadSettings::Policy::Default) {
+		ret << " " << settings.priority;
+	}
+	return ret.str();
+}
+
+std::string applyThreadSettings(const ThreadSettings& settings) {
+	std::stringstream ret;
+	#ifdef __linux__
+	pthread_t self = pthread_self();
+
+	if (!settings.name.empty()) {
+		// the kernel limit is 16 bytes including the terminator
+		const std::string& shortName = settings.name.substr(0, 15);
+		if (pthread_setname_np(self, shortName.c_str()) == 0) {
+			ret << "name: " << shortName;
+		} else {
+			ret << "name: (failed)";
+		}
+	}
+
+	if (!settings.cores.empty()) {
+		cpu_set_t set;
+		CPU_ZERO(&set);
+		for (const auto& core : settings.cores) {
+			if (core < CPU_SETSIZE) {
+				CPU_SET(core, &set);
+			}
+		}
+		const int result = pthread_setaffinity_np(self, sizeof(set), &set);
+		if (result != 0) {
+			ret << ", pinning failed: " << std::strerror(result);
+		}
+	}
+	cpu_set_t actual;
+	CPU_ZERO(&actual);
+	if (pthread_getaffinity_np(self, sizeof(actual), &actual) == 0) {
+		ret << ", cores: " << coresToString(cpuSetToCores(actual));
+	}
+
+	switch (settings.policy) {
+	case ThreadSettings::Policy::Fifo: {
+		sched_param param{};
+		param.sched_priority = std::min(
+			std::max(settings.priority, sched_get_priority_min(SCHED_FIFO)),
+			sched_get_priority_max(SCHED_FIFO)
+		);
+		const int result = pthread_setschedparam(self, SCHED_FIFO, &param);
+		if (result == 0) {
+			ret << ", policy: fifo " << param.sched_priority;
+		} else {
+			// usually EPERM without CAP_SYS_NICE or an rtprio limit
+			ret << ", policy: default (fifo failed: " << std::strerror(result) << ")";
+		}
+		break;
+	}
+	case ThreadSettings::Policy::Nice: {
+		// on Linux nice values are per thread, addressed by thread id
+		const auto tid = static_cast<id_t>(syscall(SYS_gettid));
+		if (setpriority(PRIO_PROCESS, tid, settings.priority) == 0) {
+			ret << ", policy: nice " << getpriority(PRIO_PROCESS, tid);
+		} else {
+			ret << ", policy: default (nice failed: " << std::strerror(errno) << ")";
+		}
+		break;
+	}
+	case ThreadSettings::Policy::Default:
+	default:
+		ret << ", policy: default";
+		break;
+	}
+	#elif defined(_WIN32)
+	HANDLE self = GetCurrentThread();
+
+	ret << "name: " << settings.name << " (not applied)";
+
+	if (!settings.cores.empty()) {
+		DWORD_PTR mask = 0;
+		for (const auto& core : settings.cores) {
+			if (core < sizeof(DWORD_PTR) * 8) {
+				mask |= static_cast<DWORD_PTR>(1) << core;
+			}
+		}
+		if (SetThreadAffinityMask(self, mask) != 0) {
+			ret << ", cores: " << coresToString(settings.cores);
+		} else {
+			ret << ", pinning failed: " << GetLastError();
+		}
+	} else {
+		ret << ", cores: any";
+	}
+
+	// closest Windows equivalents of the POSIX policies
+	int priority = THREAD_PRIORITY_NORMAL;
+	switch (settings.policy) {
+	case ThreadSettings::Policy::Fifo:
+		priority = THREAD_PRIORITY_TIME_CRITICAL;
+		break;
+	case ThreadSettings::Policy::Nice:
+		if (settings.priority < 0) {
+			priority = THREAD_PRIORITY_ABOVE_NORMAL;
+		} else if (settings.priority > 0) {
+			priority = THREAD_PRIORITY_BELOW_NORMAL;
+		}
+		break;
+	case ThreadSettings::Policy::Default:
+	default:
+		break;
+	}
+	if (SetThreadPriority(self, priority)) {
+		ret << ", priority: " << GetThreadPriority(self);
+	} else {
+		ret << ", priority failed: " << GetLastError();
+	}
+	#else
+	ret << "not supported on this platform";
+	#endif
+	return ret.str();
+}
+
+std::string describeCpuTopology() {
+	std::stringstream ret;
+	ret << std::thread::hardware_concurrency() << " hardware threads";
+	#ifdef __linux__
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+		ret << ", process may use cores " << coresToString(cpuSetToCores(set));
+	}
+	#endif
+	return ret.str();
+}
+
+std::string coresToString(const std::vector<unsigned int>& cores) {
+	std::vector<unsigned int> sorted = cores;
+	std::sort(sorted.begin(), sorted.end());
+	sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+
+	std::stringstream ret;
+	for (size_t i = 0; i < sorted.size(); i++) {
+		size_t last = i;
+		while (last + 1 < sorted.size() && sorted[last + 1] == sorted[last] + 1) {
+			last++;
+		}
+		if (i > 0) {
+			ret << ",";
+		}
+		ret << sorted[i];
+		if (last > i) {
+			ret << "-" << sorted[last];
+		}
+		i = last;
+	}
+	return ret.str();
+}
@@ -1,5 +1,10 @@
 #include <utilities.hpp>
 
+#include <algorithm>
+#include <climits>
+
+#include <Schema.hpp>
+
 std::string colorToString(const sf::Color& color) {
 	std::stringstream ret;
 	ret << "("
@@ -33,28 +38,41 @@ std::string nodeTypeToString(const YAML::Node& node) {
 	}
 }
 
-sf::Color nodeToColor(const YAML::Node& node) {
-	std::vector<uint8_t> color = {255, 255, 255, 255};
-
-	uint8_t i = 0;
-	for (
-		auto&& primary : color
-		) {
-		auto newPrimary = node[i++].as<uint32_t>(255);
-		if (newPrimary > 255) {
-			newPrimary = 255;
+bool nodeToColor(const YAML::Node& node, sf::Color& color) {
+	if (!node.IsSequence()) {
+		return false;
+	}
+	// missing primaries stay at full, extra ones are ignored
+	uint8_t primaries[4] = {255, 255, 255, 255};
+	size_t i = 0;
+	for (const auto& primary : node) {
+		if (i == 4) {
+			break;
+		}
+		unsigned long value = 0;
+		if (!scalarToUnsigned(primary, ULONG_MAX, value)) {
+			return false;
 		}
-		primary = static_cast<uint8_t>(newPrimary);
+		primaries[i++] = static_cast<uint8_t>(std::min(value, 255ul));
 	}
-	return {
-		color[0],
-		color[1],
-		color[2],
-		color[3]
-	};
+	color = sf::Color(primaries[0], primaries[1], primaries[2], primaries[3]);
+	return true;
 }
 
-sf::Vertex nodeToVertex(const YAML::Node& node, float size) {
-	const sf::Vertex& vertex = sf::Vertex(sf::Vector2f(node[0].as<float>(), node[1].as<float>()) * (size / 2.0f));
-	return vertex;
+bool nodeToVertex(const YAML::Node& node, const float size, sf::Vertex& vertex) {
+	if (!node.IsSequence() || node.size() < 2) {
+		return false;
+	}
+	float position[2];
+	size_t i = 0;
+	for (const auto& coordinate : node) {
+		if (i == 2) {
+			break;
+		}
+		if (!scalarToFloat(coordinate, position[i++])) {
+			return false;
+		}
+	}
+	vertex = sf::Vertex(sf::Vector2f(position[0], position[1]) * (size / 2.0f));
+	return true;
 }
@@ -0,0 +1,107 @@
+/*
+ * Behavior compiler test
+ *
+ * Compiles a behavior using every step, then the game's own behaviors, and checks
+ * the parameters came through and that ships can leave a batch. Built with AddressSanitizer, so reading YAML nodes
+ * that are already gone fails the test instead of passing by luck.
+ *
+ * usage: jage_test_behavior [behaviors.yaml]
+*/
+
+#include <cmath>
+#include <iostream>
+#include <string>
+
+#include <easylogging++.h>
+
+#include <Behavior.hpp>
+
+INITIALIZE_EASYLOGGINGPP
+
+namespace {
+
+int failures = 0;
+
+void check(const bool condition, const std::string& what) {
+	if (!condition) {
+		std::cerr << "FAILED: " << what << std::endl;
+		failures++;
+	}
+}
+
+bool near(const float a, const float b) {
+	return std::fabs(a - b) < 1e-5f;
+}
+
+}
+
+int main(const int argc, const char** argv) {
+	const std::string fileName = argc > 1 ? argv[1] : "game/behaviors.yaml";
+
+	BehaviorLibrary library;
+	check(library.loadFromNode(YAML::Load(
+		"everything:\n"
+		"  maxSpeed: 42\n"
+		"  steps:\n"
+		"    - seek: {weight: 2}\n"
+		"    - flee: {weight: 3, radius: 100}\n"
+		"    - wander: {weight: 0.25, frequency: 2}\n"
+		"    - orbit: {weight: 1, radius: 80, clockwise: false}\n"
+		"    - formation: {weight: 1, spacing: 30, columns: 4, distance: 120}\n"
+		"    - fire: {interval: 0.5, count: 3, spread: 10, aimed: false}\n"
+		"broken:\n"
+		"  steps:\n"
+		"    - teleport: {}\n"
+	)) == false, "an unknown step makes the load report a problem");
+
+	const BehaviorProgram* program = library.find("everything");
+	check(program != nullptr, "the behavior is found by name");
+	if (program != nullptr) {
+		check(near(program->maxSpeed, 42.0f), "maxSpeed");
+		check(program->code.size() == 6, "every step compiles");
+		if (program->code.size() == 6) {
+			const auto& code = program->code;
+			check(code[0].op == BehaviorOp::Seek && near(code[0].a, 2.0f), "seek");
+			check(code[1].op == BehaviorOp::Flee && near(code[1].a, 3.0f) && near(code[1].b, 100.0f), "flee");
+			check(code[2].op == BehaviorOp::Wander && near(code[2].a, 0.25f) && near(code[2].b, 2.0f), "wander");
+			check(code[3].op == BehaviorOp::Orbit && near(code[3].b, 80.0f) && near(code[3].c, -1.0f), "orbit");
+			check(
+				code[4].op == BehaviorOp::Formation && near(code[4].b, 30.0f) && near(code[4].c, 4.0f)
+					&& near(code[4].d, 120.0f),
+				"formation"
+			);
+			check(
+				code[5].op == BehaviorOp::Fire && near(code[5].a, 0.5f) && near(code[5].b, 3.0f)
+					&& near(code[5].c, 10.0f) && near(code[5].d, 0.0f),
+				"fire"
+			);
+		}
+	}
+	if (program != nullptr) {
+		BehaviorBatch batch(*program);
+		batch.add(1.0f, 10.0f);
+		batch.add(2.0f, 20.0f);
+		batch.add(3.0f, 30.0f);
+		batch.remove(0);
+		check(batch.size() == 2 && batch.dirX.size() == 2, "removing a ship shrinks the batch");
+		check(near(batch.x[0], 3.0f) && near(batch.y[0], 30.0f), "the last ship takes the removed one's place");
+		batch.remove(1);
+		check(batch.size() == 1 && near(batch.x[0], 3.0f), "removing the last ship leaves the rest");
+		batch.evaluate(0.1f, 0.0f, 0.0f);
+		check(batch.dirX.size() == 1, "a shrunk batch still evaluates");
+	}
+	const BehaviorProgram* broken = library.find("broken");
+	check(broken != nullptr && broken->code.empty(), "invalid steps are skipped");
+
+	BehaviorLibrary game;
+	check(game.loadFromYAML(fileName), "the game's behaviors load");
+	for (const char* name : {"hunter", "swarm", "kamikaze"}) {
+		const BehaviorProgram* gameProgram = game.find(name);
+		check(gameProgram != nullptr && !gameProgram->code.empty(), std::string("game behavior ") + name);
+	}
+
+	if (failures == 0) {
+		std::cout << "behavior test passed" << std::endl;
+	}
+	return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
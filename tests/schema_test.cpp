@@ -0,0 +1,116 @@
+/*
+ * Config schema test
+ *
+ * Parses a config full of mistakes and checks every one of them is reported
+ * with its path in a single pass, that the defaults survive them, and that the
+ * scalar parsers turn down what yaml-cpp's own conversions would let through.
+ *
+ * usage: jage_test_schema
+*/
+
+#include <algorithm>
+#include <iostream>
+#include <string>
+
+#include <Config.hpp>
+#include <Schema.hpp>
+
+namespace {
+
+int failures = 0;
+
+void check(const bool condition, const std::string& what) {
+	if (!condition) {
+		std::cerr << "FAILED: " << what << std::endl;
+		failures++;
+	}
+}
+
+bool reported(const SchemaErrors& errors, const std::string& problem) {
+	const auto& problems = errors.get();
+	return std::find(problems.begin(), problems.end(), problem) != problems.end();
+}
+
+bool rejectsUnsigned(const std::string& text) {
+	unsigned long value = 0;
+	return !scalarToUnsigned(YAML::Load(text), 1000, value);
+}
+
+bool rejectsFloat(const std::string& text) {
+	float value = 0.0f;
+	return !scalarToFloat(YAML::Load(text), value);
+}
+
+}
+
+int main() {
+	const EngineConfig defaults;
+	EngineConfig config;
+	SchemaErrors errors;
+	const bool ok = parseEngineConfig(YAML::Load(
+		"name: Test\n"
+		"widht: 800\n"
+		"height: 600\n"
+		"vsync: maybe\n"
+		"targetFps: -60\n"
+		"deadzone: nan\n"
+		"network:\n"
+		"  port: 0x10\n"
+		"  loss: 1.5\n"
+		"  latency: 20\n"
+		"  bogus: 1\n"
+		"threads:\n"
+		"  render: {policy: realtime, cores: [1, 2]}\n"
+		"  sim: {}\n"
+		"memoryBudgets: {assets: 8, gpu: 1}\n"
+	), config, SchemaPath{nullptr, "config.yaml"}, errors);
+
+	check(!ok, "a config with problems isn't ok");
+	check(errors.get().size() == 10, "every problem is reported, got " + std::to_string(errors.get().size()));
+	for (const char* problem : {
+		"config.yaml has an unknown key 'widht'",
+		"config.yaml: vsync should be true or false",
+		"config.yaml: targetFps should be a positive whole number",
+		"config.yaml: deadzone should be a number",
+		"config.yaml: network.port should be a positive whole number up to 65535",
+		"config.yaml: network.loss should be from 0 to 1",
+		"config.yaml: network has an unknown key 'bogus'",
+		"config.yaml: threads.render.policy should be default, nice or fifo",
+		"config.yaml: threads has an unknown key 'sim'",
+		"config.yaml: memoryBudgets has an unknown key 'gpu'"
+	}) {
+		check(reported(errors, problem), std::string("reported: ") + problem);
+	}
+	for (const auto& problem : errors.get()) {
+		std::cout << problem << std::endl;
+	}
+
+	// good values around the bad ones still get through
+	check(config.name == "Test", "name is read");
+	check(config.height == 600, "height is read");
+	check(config.network.conditions.latency == 20.0f, "network.latency is read");
+	check(config.threads.render.cores.size() == 2, "threads.render.cores is read");
+	check(config.memoryBudgets[static_cast<size_t>(AllocationTag::Assets)] == 8.0f, "memoryBudgets.assets is read");
+	// and the bad ones keep their defaults
+	check(config.width == defaults.width, "width keeps its default");
+	check(config.vsync == defaults.vsync, "vsync keeps its default");
+	check(config.targetFps == defaults.targetFps, "targetFps keeps its default");
+	check(config.deadZone == defaults.deadZone, "deadzone keeps its default");
+	check(config.network.port == defaults.network.port, "network.port keeps its default");
+	check(config.network.conditions.loss == defaults.network.conditions.loss, "network.loss keeps its default");
+	check(config.threads.render.policy == defaults.threads.render.policy, "threads.render.policy keeps its default");
+
+	for (const char* text : {"-1", "0x10", "+1", "1.5", "1e3", "", "1001", "[1]"}) {
+		check(rejectsUnsigned(text), std::string("unsigned rejects '") + text + "'");
+	}
+	unsigned long number = 0;
+	check(scalarToUnsigned(YAML::Load("1000"), 1000, number) && number == 1000, "unsigned takes its maximum");
+	for (const char* text : {"nan", "inf", "-inf", "1e99", "1.5x", "", "[1]"}) {
+		check(rejectsFloat(text), std::string("float rejects '") + text + "'");
+	}
+
+	if (failures == 0) {
+		std::cout << "schema test passed" << std::endl;
+	}
+	return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
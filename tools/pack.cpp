@@ -0,0 +1,74 @@
+/*
+ * Pack file builder
+ *
+ * Bundles a game's data files into one pack the engine can memory-map.
+ * Files keep their path relative to the game directory as their name.
+ *
+ * usage: jage_pack <output.jpak> <game directory> <file>...
+ *        jage_pack --list <pack.jpak>
+*/
+
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include <Pack.hpp>
+
+namespace {
+
+int listPack(const std::string& fileName) {
+	PackFile pack;
+	if (!pack.open(fileName)) {
+		std::cerr << "Can't open pack '" << fileName << "'" << std::endl;
+		return EXIT_FAILURE;
+	}
+	for (const auto& entry : pack.getEntries()) {
+		std::cout << entry.size << "\t" << entry.name << std::endl;
+	}
+	std::cout << pack.getEntries().size() << " files, " << pack.getSize() << " bytes" << std::endl;
+	return EXIT_SUCCESS;
+}
+
+}
+
+int main(const int argc, const char** argv) {
+	if (argc == 3 && std::string(argv[1]) == "--list") {
+		return listPack(argv[2]);
+	}
+	if (argc < 4) {
+		std::cerr << "usage: " << argv[0] << " <output.jpak> <game directory> <file>..." << std::endl;
+		std::cerr << "       " << argv[0] << " --list <pack.jpak>" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	const std::string outputName = argv[1];
+	const std::string gameDir = argv[2];
+	std::vector<PackInput> files;
+	size_t totalSize = 0;
+	for (int arg = 3; arg < argc; arg++) {
+		std::string name = argv[arg];
+		// always forward slashes, so packs built on Windows work everywhere
+		for (auto& character : name) {
+			if (character == '\\') {
+				character = '/';
+			}
+		}
+		std::ifstream file(gameDir + "/" + name, std::ios::binary);
+		if (!file) {
+			std::cerr << "Can't read '" << gameDir << "/" << name << "'" << std::endl;
+			return EXIT_FAILURE;
+		}
+		std::vector<char> contents{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+		totalSize += contents.size();
+		files.emplace_back(name, std::move(contents));
+	}
+
+	if (!writePack(outputName, files)) {
+		std::cerr << "Can't write pack '" << outputName << "'" << std::endl;
+		return EXIT_FAILURE;
+	}
+	std::cout << "Packed " << files.size() << " files, " << totalSize << " bytes, into '" << outputName << "'" << std::endl;
+	return EXIT_SUCCESS;
+}